@@ -0,0 +1,347 @@
+#pragma once
+
+// JSON for the tools, a pull parser that streams large files and a small DOM for the parts that are kept.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct json_value {
+	enum type { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+	enum type type = JSON_NULL;
+	bool boolean = false;
+	double number = 0.0;
+	std::string str;
+	std::vector<json_value> items;
+	std::vector<std::pair<std::string, json_value>> members;
+
+	const json_value *get(const char *key) const
+	{
+		for (const auto &member : members) {
+			if (member.first == key)
+				return &member.second;
+		}
+		return nullptr;
+	}
+	std::string get_string(const char *key) const
+	{
+		const json_value *v = get(key);
+		return v && v->type == JSON_STRING ? v->str : std::string();
+	}
+	long long get_int(const char *key) const
+	{
+		const json_value *v = get(key);
+		return v && v->type == JSON_NUMBER ? (long long)v->number : 0;
+	}
+	const std::vector<json_value> &get_array(const char *key) const
+	{
+		static const std::vector<json_value> empty;
+		const json_value *v = get(key);
+		return v && v->type == json_value::JSON_ARRAY ? v->items : empty;
+	}
+};
+
+// pull parser over a buffered file or a string, values that are not needed are skipped without being stored
+class json_reader {
+	FILE *file = nullptr;
+	char buffer[65536];
+	// the buffer, or the string the reader was made for
+	const char *data = buffer;
+	size_t pos = 0;
+	size_t len = 0;
+	size_t line = 1;
+	std::string error_message;
+
+	int peek()
+	{
+		if (pos == len) {
+			if (!file)
+				return EOF;
+			len = fread(buffer, 1, sizeof(buffer), file);
+			pos = 0;
+			if (!len)
+				return EOF;
+		}
+		return (unsigned char)data[pos];
+	}
+	int get()
+	{
+		const int c = peek();
+		if (c != EOF) {
+			pos++;
+			if (c == '\n')
+				line++;
+		}
+		return c;
+	}
+	int peek_token()
+	{
+		int c = peek();
+		while (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+			get();
+			c = peek();
+		}
+		return c;
+	}
+	bool expect(char expected)
+	{
+		if (peek_token() == expected) {
+			get();
+			return true;
+		}
+		return fail(std::string("expected '") + expected + "'");
+	}
+	bool expect_word(const char *word)
+	{
+		for (const char *w = word; *w; w++) {
+			if (get() != *w)
+				return fail(std::string("expected ") + word);
+		}
+		return true;
+	}
+	static void append_utf8(std::string &str, uint32_t cp)
+	{
+		if (cp < 0x80) {
+			str += (char)cp;
+		} else if (cp < 0x800) {
+			str += (char)(0xC0 | (cp >> 6));
+			str += (char)(0x80 | (cp & 0x3F));
+		} else if (cp < 0x10000) {
+			str += (char)(0xE0 | (cp >> 12));
+			str += (char)(0x80 | ((cp >> 6) & 0x3F));
+			str += (char)(0x80 | (cp & 0x3F));
+		} else {
+			str += (char)(0xF0 | (cp >> 18));
+			str += (char)(0x80 | ((cp >> 12) & 0x3F));
+			str += (char)(0x80 | ((cp >> 6) & 0x3F));
+			str += (char)(0x80 | (cp & 0x3F));
+		}
+	}
+	bool read_hex4(uint32_t &value)
+	{
+		value = 0;
+		for (int i = 0; i < 4; i++) {
+			const int c = get();
+			value <<= 4;
+			if (c >= '0' && c <= '9')
+				value |= (uint32_t)(c - '0');
+			else if (c >= 'a' && c <= 'f')
+				value |= (uint32_t)(c - 'a' + 10);
+			else if (c >= 'A' && c <= 'F')
+				value |= (uint32_t)(c - 'A' + 10);
+			else
+				return fail("invalid unicode escape");
+		}
+		return true;
+	}
+	// str is null when the std::string is skipped
+	bool string_body(std::string *str)
+	{
+		if (!expect('"'))
+			return false;
+		for (;;) {
+			int c = get();
+			if (c == EOF)
+				return fail("unterminated string");
+			if (c == '"')
+				return true;
+			if (c != '\\') {
+				if (str)
+					*str += (char)c;
+				continue;
+			}
+			c = get();
+			char escaped;
+			switch (c) {
+			case '"':
+			case '\\':
+			case '/':
+				escaped = (char)c;
+				break;
+			case 'b':
+				escaped = '\b';
+				break;
+			case 'f':
+				escaped = '\f';
+				break;
+			case 'n':
+				escaped = '\n';
+				break;
+			case 'r':
+				escaped = '\r';
+				break;
+			case 't':
+				escaped = '\t';
+				break;
+			case 'u': {
+				uint32_t cp;
+				if (!read_hex4(cp))
+					return false;
+				if (cp >= 0xD800 && cp < 0xDC00 && peek() == '\\') {
+					get();
+					uint32_t low;
+					if (get() != 'u' || !read_hex4(low))
+						return fail("invalid surrogate pair");
+					cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+				}
+				if (str)
+					append_utf8(*str, cp);
+				continue;
+			}
+			default:
+				return fail("invalid escape");
+			}
+			if (str)
+				*str += escaped;
+		}
+	}
+	bool fail(const std::string &message)
+	{
+		if (error_message.empty())
+			error_message = "line " + std::to_string(line) + ": " + message;
+		return false;
+	}
+
+public:
+	json_reader(FILE *f) : file(f) {}
+	// the string has to outlive the reader
+	json_reader(const std::string &text) : data(text.data()), len(text.size()) {}
+
+	const std::string &error() const { return error_message; }
+	bool at_end() { return peek_token() == EOF; }
+	bool is_object() { return peek_token() == '{'; }
+	bool is_array() { return peek_token() == '['; }
+
+	bool begin_object() { return expect('{'); }
+	// reads the key of the next member, false at the end of the object or on an error
+	bool next_key(std::string &key, bool &first)
+	{
+		int c = peek_token();
+		if (c == '}') {
+			get();
+			return false;
+		}
+		if (!first && !expect(','))
+			return false;
+		first = false;
+		key.clear();
+		return string_body(&key) && expect(':');
+	}
+	bool begin_array() { return expect('['); }
+	// false at the end of the array or on an error
+	bool next_item(bool &first)
+	{
+		if (peek_token() == ']') {
+			get();
+			return false;
+		}
+		if (!first && !expect(','))
+			return false;
+		first = false;
+		return true;
+	}
+
+	bool read_string(std::string &str)
+	{
+		str.clear();
+		if (peek_token() != '"')
+			return skip_value();
+		return string_body(&str);
+	}
+
+	bool read_value(json_value &value)
+	{
+		const int c = peek_token();
+		bool first = true;
+		std::string key;
+		switch (c) {
+		case '{':
+			value.type = json_value::JSON_OBJECT;
+			get();
+			while (next_key(key, first)) {
+				value.members.emplace_back(key, json_value());
+				if (!read_value(value.members.back().second))
+					return false;
+			}
+			return error_message.empty();
+		case '[':
+			value.type = json_value::JSON_ARRAY;
+			get();
+			while (next_item(first)) {
+				value.items.emplace_back();
+				if (!read_value(value.items.back()))
+					return false;
+			}
+			return error_message.empty();
+		case '"':
+			value.type = json_value::JSON_STRING;
+			return string_body(&value.str);
+		case 't':
+			value.type = json_value::JSON_BOOL;
+			value.boolean = true;
+			return expect_word("true");
+		case 'f':
+			value.type = json_value::JSON_BOOL;
+			return expect_word("false");
+		case 'n':
+			return expect_word("null");
+		default: {
+			std::string number;
+			int d = peek();
+			while (d == '-' || d == '+' || d == '.' || d == 'e' || d == 'E' || (d >= '0' && d <= '9')) {
+				number += (char)get();
+				d = peek();
+			}
+			if (number.empty())
+				return fail(c == EOF ? "unexpected end of file" : "unexpected character");
+			value.type = json_value::JSON_NUMBER;
+			value.number = std::strtod(number.c_str(), nullptr);
+			return true;
+		}
+		}
+	}
+
+	bool skip_value()
+	{
+		const int c = peek_token();
+		bool first = true;
+		switch (c) {
+		case '{':
+			get();
+			while (next_key_skip(first)) {
+				if (!skip_value())
+					return false;
+			}
+			return error_message.empty();
+		case '[':
+			get();
+			while (next_item(first)) {
+				if (!skip_value())
+					return false;
+			}
+			return error_message.empty();
+		case '"':
+			return string_body(nullptr);
+		default: {
+			json_value scalar;
+			return read_value(scalar);
+		}
+		}
+	}
+
+private:
+	bool next_key_skip(bool &first)
+	{
+		if (peek_token() == '}') {
+			get();
+			return false;
+		}
+		if (!first && !expect(','))
+			return false;
+		first = false;
+		return string_body(nullptr) && expect(':');
+	}
+};
@@ -0,0 +1,305 @@
+// Replays a switch log recorded with the start_recording request through the rule engine, without OBS.
+// Every override pass and prepared switch of the show is resolved again and timed, and the overrides
+// every canvas ends with are printed, so the output of two builds can be diffed.
+
+#include "json-reader.hpp"
+#include "transition-log.hpp"
+#include "transition-rules.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// what the plugin logs of a canvas, see rules_snapshot_to_json
+struct replay_canvas {
+	transition_rules rules;
+	transition_rules base;
+	bool has_base = false;
+	scene_group_table groups;
+	enum rule_precedence precedence = RULE_PRECEDENCE_FROM_SCENE;
+	vector<string> scenes;
+	unique_ptr<transition_decision_table> table;
+	string current_scene;
+	map<string, transition_info> overrides;
+};
+
+struct replay_result {
+	size_t passes = 0;
+	size_t resolves = 0;
+	size_t overrides_written = 0;
+	size_t requests = 0;
+	// every pass and every prepared switch, single resolves are too short to time on their own
+	vector<uint64_t> pass_ns;
+	vector<uint64_t> prepare_ns;
+};
+
+static uint64_t now_ns()
+{
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+static bool read_uint(const string &data, size_t &pos, uint64_t &value, size_t bytes)
+{
+	if (data.size() - pos < bytes)
+		return false;
+	value = 0;
+	for (size_t i = 0; i < bytes; i++)
+		value |= (uint64_t)(unsigned char)data[pos + i] << (8 * i);
+	pos += bytes;
+	return true;
+}
+
+// a corrupt length fails the read instead of reading past the end
+static bool read_string(const string &data, size_t &pos, string &s)
+{
+	uint64_t size;
+	if (!read_uint(data, pos, size, 4) || size > data.size() - pos)
+		return false;
+	s.assign(data, pos, (size_t)size);
+	pos += (size_t)size;
+	return true;
+}
+
+static bool read_log(const char *path, vector<switch_log_entry> &entries)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return false;
+	string data;
+	char buffer[65536];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		data.append(buffer, n);
+	fclose(f);
+	if (data.size() < sizeof(switch_log_magic) || memcmp(data.data(), switch_log_magic, sizeof(switch_log_magic)) != 0)
+		return false;
+	size_t pos = sizeof(switch_log_magic);
+	while (pos < data.size()) {
+		switch_log_entry entry;
+		uint64_t kind;
+		if (!read_uint(data, pos, kind, 1) || kind > SWITCH_LOG_RULE_CHANGES || !read_uint(data, pos, entry.time, 8) ||
+		    !read_string(data, pos, entry.canvas) || !read_string(data, pos, entry.a) || !read_string(data, pos, entry.b))
+			return false;
+		entry.kind = (enum switch_log_kind)kind;
+		entries.push_back(std::move(entry));
+	}
+	return true;
+}
+
+static bool parse_json(const string &text, json_value &value)
+{
+	json_reader reader(text);
+	return reader.read_value(value) && value.type == json_value::JSON_OBJECT;
+}
+
+static void rules_from_json(const vector<json_value> &transitions, transition_rules &rules)
+{
+	for (const auto &transition : transitions) {
+		auto &t = rules[transition.get_string("from_scene")][transition.get_string("to_scene")];
+		t.transition = transition.get_string("transition");
+		t.duration = (int)transition.get_int("duration");
+	}
+}
+
+static vector<string> names_from_json(const vector<json_value> &array)
+{
+	vector<string> names;
+	names.reserve(array.size());
+	for (const auto &item : array)
+		names.push_back(item.get_string("name"));
+	return names;
+}
+
+static void replay_snapshot(replay_canvas &rc, const string &json)
+{
+	json_value obj;
+	if (!parse_json(json, obj))
+		return;
+	rc.precedence = (enum rule_precedence)obj.get_int("precedence");
+	rc.rules.clear();
+	rules_from_json(obj.get_array("transitions"), rc.rules);
+	rc.base.clear();
+	rc.has_base = obj.get("base") != nullptr;
+	rules_from_json(obj.get_array("base"), rc.base);
+	rc.scenes = names_from_json(obj.get_array("scenes"));
+	rc.groups = scene_group_table();
+	for (const auto &group : obj.get_array("groups")) {
+		vector<uint64_t> members;
+		for (const auto &sceneName : names_from_json(group.get_array("scenes"))) {
+			const size_t id = intern_group_scene(rc.groups, sceneName);
+			if (members.size() <= id / 64)
+				members.resize(id / 64 + 1);
+			members[id / 64] |= (uint64_t)1 << (id % 64);
+		}
+		rc.groups.groups[group.get_string("name")] = std::move(members);
+	}
+	rc.table.reset();
+}
+
+// the format of the undo data, see transition_changes_to_json
+static void replay_rule_changes(replay_canvas &rc, const string &json, bool base)
+{
+	json_value obj;
+	if (!parse_json(json, obj))
+		return;
+	const vector<string> names = names_from_json(obj.get_array("names"));
+	auto name = [&names](const json_value &item, const char *field) -> const string * {
+		const json_value *v = item.get(field);
+		if (!v || v->type != json_value::JSON_NUMBER || v->number < 0 || (size_t)v->number >= names.size())
+			return nullptr;
+		return &names[(size_t)v->number];
+	};
+	auto &rules = base ? rc.base : rc.rules;
+	rc.has_base = rc.has_base || base;
+	for (const auto &item : obj.get_array("changes")) {
+		const string *from_scene = name(item, "f");
+		const string *to_scene = name(item, "t");
+		if (!from_scene || !to_scene)
+			continue;
+		// no transition is a removed rule
+		if (item.get("x")) {
+			const string *transition = name(item, "x");
+			if (transition)
+				rules[*from_scene][*to_scene] = {*transition, (int)item.get_int("d")};
+			continue;
+		}
+		auto fs_it = rules.find(*from_scene);
+		if (fs_it == rules.end())
+			continue;
+		fs_it->second.erase(*to_scene);
+		if (fs_it->second.empty())
+			rules.erase(fs_it);
+	}
+	rc.table.reset();
+}
+
+static void replay_override(replay_canvas &rc, const string &sceneName, replay_result &result)
+{
+	if (!rc.table) {
+		rc.table = make_unique<transition_decision_table>();
+		rc.table->compile(rc.rules, rc.has_base ? &rc.base : nullptr, &rc.groups, rc.precedence);
+	}
+	const transition_info *t = rc.table->resolve(rc.current_scene, sceneName);
+	result.resolves++;
+	auto it = rc.overrides.find(sceneName);
+	if (!t) {
+		if (it != rc.overrides.end()) {
+			rc.overrides.erase(it);
+			result.overrides_written++;
+		}
+	} else if (it == rc.overrides.end() || it->second != *t) {
+		rc.overrides[sceneName] = *t;
+		result.overrides_written++;
+	}
+}
+
+// the same pass set_transition_overrides_queued makes, against the overrides kept in the replay
+static void replay_pass(replay_canvas &rc, replay_result &result)
+{
+	const uint64_t start = now_ns();
+	for (const auto &sceneName : rc.scenes)
+		replay_override(rc, sceneName, result);
+	result.pass_ns.push_back(now_ns() - start);
+	result.passes++;
+}
+
+static void replay_rename(replay_canvas &rc, const string &prev_name, const string &new_name)
+{
+	rename_scene_in_rules(rc.rules, prev_name, new_name);
+	rename_scene_in_rules(rc.base, prev_name, new_name);
+	rename_scene_in_groups(rc.groups, prev_name, new_name);
+	std::replace(rc.scenes.begin(), rc.scenes.end(), prev_name, new_name);
+	if (rc.current_scene == prev_name)
+		rc.current_scene = new_name;
+	auto it = rc.overrides.find(prev_name);
+	if (it != rc.overrides.end()) {
+		rc.overrides[new_name] = it->second;
+		rc.overrides.erase(it);
+	}
+	rc.table.reset();
+}
+
+static void print_latency(const char *name, vector<uint64_t> &ns)
+{
+	if (ns.empty())
+		return;
+	sort(ns.begin(), ns.end());
+	uint64_t total = 0;
+	for (uint64_t n : ns)
+		total += n;
+	printf("%s: %zu, mean %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n", name, ns.size(),
+	       (double)total / ns.size() / 1e3, (double)ns[ns.size() / 2] / 1e3, (double)ns[ns.size() * 99 / 100] / 1e3,
+	       (double)ns.back() / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2) {
+		fputs("usage: transition-log-replay <log>\n"
+		      "Replays a switch log recorded with the start_recording request.\n",
+		      stderr);
+		return 2;
+	}
+	vector<switch_log_entry> entries;
+	if (!read_log(argv[1], entries)) {
+		fprintf(stderr, "%s: not a switch log or truncated\n", argv[1]);
+		return 2;
+	}
+	map<string, replay_canvas> canvases;
+	replay_result result;
+	const uint64_t start = now_ns();
+	for (const auto &entry : entries) {
+		auto &rc = canvases[entry.canvas];
+		switch (entry.kind) {
+		case SWITCH_LOG_RULES:
+			replay_snapshot(rc, entry.a);
+			break;
+		case SWITCH_LOG_CHANNEL_CHANGE:
+		case SWITCH_LOG_SCENE_CHANGED:
+			rc.current_scene = entry.a;
+			if (std::find(rc.scenes.begin(), rc.scenes.end(), entry.a) == rc.scenes.end())
+				rc.scenes.push_back(entry.a);
+			replay_pass(rc, result);
+			break;
+		case SWITCH_LOG_TRANSITION_START:
+			replay_pass(rc, result);
+			break;
+		case SWITCH_LOG_RENAME:
+			replay_rename(rc, entry.a, entry.b);
+			break;
+		case SWITCH_LOG_PREPARE_SWITCH: {
+			const uint64_t prepare_start = now_ns();
+			replay_override(rc, entry.a, result);
+			result.prepare_ns.push_back(now_ns() - prepare_start);
+			break;
+		}
+		case SWITCH_LOG_REQUEST:
+			result.requests++;
+			break;
+		case SWITCH_LOG_RULE_CHANGES:
+			replay_rule_changes(rc, entry.a, entry.b == "base");
+			break;
+		}
+	}
+	const uint64_t elapsed = now_ns() - start;
+
+	printf("%zu entries, %.1f s of log replayed in %.3f ms\n", entries.size(),
+	       entries.empty() ? 0.0 : (double)entries.back().time / 1e9, (double)elapsed / 1e6);
+	printf("%zu passes, %zu resolves, %zu overrides written, %zu requests\n", result.passes, result.resolves,
+	       result.overrides_written, result.requests);
+	print_latency("override pass", result.pass_ns);
+	print_latency("prepared switch", result.prepare_ns);
+	for (const auto &it : canvases) {
+		printf("%s: current scene %s\n", it.first.c_str(), it.second.current_scene.c_str());
+		for (const auto &o : it.second.overrides)
+			printf("  %s: %s %d ms\n", o.first.c_str(), o.second.transition.c_str(), o.second.duration);
+	}
+	return 0;
+}
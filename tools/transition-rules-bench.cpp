@@ -0,0 +1,278 @@
+// Benchmarks the rule engine on synthetic collections, without OBS. Resolves are timed in batches, the clock
+// costs about as much as a cached resolve. Allocations are counted with a replacement operator new, so every
+// line also shows what the operation allocates.
+// The scenarios follow what the plugin does: resolving single pairs, the override pass after every switch,
+// the recompile and lint after an edit and the rename of a scene through its rules, profiles and groups.
+
+#include "transition-rules.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the benchmark is single threaded, the counters only move inside measure
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void *operator new(size_t size)
+{
+	allocations++;
+	allocated_bytes += size;
+	if (void *p = malloc(size ? size : 1))
+		return p;
+	throw bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+static uint64_t now_ns()
+{
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+struct measurement {
+	size_t ops = 0;
+	uint64_t total_ns = 0;
+	// per op, of every batch
+	vector<double> batch_ns;
+	size_t allocations = 0;
+	size_t bytes = 0;
+};
+
+// f(i) runs op i, batches of ops are timed together
+template<class F> static measurement measure(size_t ops, size_t batch, F &&f)
+{
+	measurement m;
+	m.ops = ops;
+	const size_t allocations_before = allocations;
+	const size_t bytes_before = allocated_bytes;
+	for (size_t i = 0; i < ops;) {
+		const size_t end = min(ops, i + batch);
+		const uint64_t start = now_ns();
+		for (; i < end; i++)
+			f(i);
+		const uint64_t elapsed = now_ns() - start;
+		m.total_ns += elapsed;
+		m.batch_ns.push_back((double)elapsed / (double)batch);
+	}
+	m.allocations = allocations - allocations_before;
+	m.bytes = allocated_bytes - bytes_before;
+	return m;
+}
+
+static void print_measurement(const char *name, measurement &m)
+{
+	if (!m.ops)
+		return;
+	sort(m.batch_ns.begin(), m.batch_ns.end());
+	auto time = [](double ns) {
+		char buffer[32];
+		if (ns >= 1e6)
+			snprintf(buffer, sizeof(buffer), "%.2f ms", ns / 1e6);
+		else if (ns >= 1e3)
+			snprintf(buffer, sizeof(buffer), "%.2f us", ns / 1e3);
+		else
+			snprintf(buffer, sizeof(buffer), "%.1f ns", ns);
+		return string(buffer);
+	};
+	printf("%-16s %8zu x %10s  p50 %10s  max %10s  %8.1f allocs %10.0f bytes per op\n", name, m.ops,
+	       time((double)m.total_ns / (double)m.ops).c_str(), time(m.batch_ns[m.batch_ns.size() / 2]).c_str(),
+	       time(m.batch_ns.back()).c_str(), (double)m.allocations / (double)m.ops,
+	       (double)m.bytes / (double)m.ops);
+}
+
+struct lcg {
+	uint32_t state;
+	uint32_t next()
+	{
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+	double unit() { return (double)next() / (double)(1u << 24); }
+};
+
+// Any rules for every tenth to scene, a group rule and the given share of scene to scene rules
+static transition_rules benchmark_rules(const vector<string> &scenes, double density, uint32_t seed)
+{
+	transition_rules rules;
+	lcg rng{seed};
+	for (size_t i = 0; i < scenes.size(); i += 10)
+		rules["Any"][scenes[i]] = {"Fade", 300};
+	rules["group:Cameras"]["Any"] = {"Cut", 0};
+	for (const auto &from : scenes) {
+		for (const auto &to : scenes) {
+			if (from != to && rng.unit() < density)
+				rules[from][to] = {rng.unit() < 0.5 ? "Cut" : "Stinger", (int)(rng.unit() * 1000.0)};
+		}
+	}
+	return rules;
+}
+
+// every fifth scene is a camera
+static scene_group_table benchmark_groups(const vector<string> &scenes)
+{
+	scene_group_table groups;
+	auto &members = groups.groups["group:Cameras"];
+	for (size_t i = 0; i < scenes.size(); i += 5) {
+		const size_t id = intern_group_scene(groups, scenes[i]);
+		if (members.size() <= id / 64)
+			members.resize(id / 64 + 1);
+		members[id / 64] |= (uint64_t)1 << (id % 64);
+	}
+	return groups;
+}
+
+// the pass set_transition_overrides_queued makes, overrides are only written when they change
+static size_t override_pass(transition_decision_table &dt, const string &current, const vector<string> &scenes,
+			    map<string, transition_info> &overrides)
+{
+	size_t written = 0;
+	for (const auto &sceneName : scenes) {
+		const transition_info *t = dt.resolve(current, sceneName);
+		auto it = overrides.find(sceneName);
+		if (!t) {
+			if (it != overrides.end()) {
+				overrides.erase(it);
+				written++;
+			}
+		} else if (it == overrides.end() || it->second != *t) {
+			overrides[sceneName] = *t;
+			written++;
+		}
+	}
+	return written;
+}
+
+int main(int argc, char **argv)
+{
+	const size_t scene_count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 500;
+	const double density = argc > 2 ? strtod(argv[2], nullptr) : 0.05;
+	const size_t profile_count = argc > 3 ? strtoul(argv[3], nullptr, 10) : 2;
+	if (argc > 4 || !scene_count || density < 0.0 || density > 1.0) {
+		fputs("usage: transition-rules-bench [<scenes> [<density> [<profiles>]]]\n"
+		      "Density is the share of scene pairs with a rule, profiles are copies of the rules a rename also\n"
+		      "goes through.\n",
+		      stderr);
+		return 2;
+	}
+	// resolving every pair of a large collection takes too long, those get a sample
+	const size_t max_pairs = 250000;
+	const size_t batch = 1000;
+
+	vector<string> scenes;
+	for (size_t i = 0; i < scene_count; i++)
+		scenes.push_back("Scene " + to_string(i + 1));
+	transition_rules rules = benchmark_rules(scenes, density, 1);
+	scene_group_table groups = benchmark_groups(scenes);
+	vector<transition_rules> profiles(profile_count, rules);
+	const vector<string> transitions = {"Cut", "Fade", "Stinger"};
+	size_t rule_count = 0;
+	for (const auto &from : rules)
+		rule_count += from.second.size();
+
+	auto compile = [&](transition_decision_table &dt) {
+		dt.compile(rules, nullptr, &groups, RULE_PRECEDENCE_FROM_SCENE);
+	};
+	measurement compile_m = measure(20, 1, [&](size_t) {
+		transition_decision_table dt;
+		compile(dt);
+	});
+
+	transition_decision_table dt;
+	compile(dt);
+	const size_t all_pairs = scene_count * scene_count;
+	const size_t pair_count = min(all_pairs, max_pairs);
+	vector<pair<uint32_t, uint32_t>> pairs;
+	pairs.reserve(pair_count);
+	lcg rng{1};
+	for (size_t i = 0; i < pair_count; i++) {
+		const size_t p = pair_count == all_pairs ? i : rng.next() % all_pairs;
+		pairs.emplace_back((uint32_t)(p / scene_count), (uint32_t)(p % scene_count));
+	}
+	auto resolve_pair = [&](size_t i) { dt.resolve(scenes[pairs[i].first], scenes[pairs[i].second]); };
+	measurement cold = measure(pair_count, batch, resolve_pair);
+	measurement warm = measure(pair_count, batch, resolve_pair);
+	measurement uncached = measure(pair_count, batch, [&](size_t i) {
+		dt.resolve_uncached(scenes[pairs[i].first], scenes[pairs[i].second]);
+	});
+	const decision_table_memory memory = dt.memory();
+
+	// a show switching through the scenes, every switch is a pass over all of them
+	const size_t switches = min(scene_count, (size_t)200);
+	map<string, transition_info> overrides;
+	size_t written = 0;
+	transition_decision_table pass_dt;
+	compile(pass_dt);
+	measurement pass = measure(switches, 1, [&](size_t i) {
+		written += override_pass(pass_dt, scenes[(i * 7) % scene_count], scenes, overrides);
+	});
+
+	// an edit drops the compiled table, the next switch compiles it again and makes a pass
+	measurement edit = measure(20, 1, [&](size_t i) {
+		rules[scenes[i % scene_count]][scenes[(i * 13 + 1) % scene_count]] = {"Fade", (int)i};
+		transition_decision_table edited;
+		compile(edited);
+		override_pass(edited, scenes[i % scene_count], scenes, overrides);
+	});
+	// the lint after an edit runs on a worker, it does not hold up switches
+	measurement lint = measure(3, 1, [&](size_t) {
+		lint_transition_rules(rules, nullptr, &groups, RULE_PRECEDENCE_FROM_SCENE, scenes, transitions);
+	});
+
+	// what rename_scene does to the rules: the groups, every profile and the own rules, then the recompile
+	const size_t renames = min(scene_count, (size_t)100);
+	measurement rename = measure(renames, 1, [&](size_t i) {
+		const string prev_name = scenes[i];
+		const string new_name = prev_name + " renamed";
+		rename_scene_in_groups(groups, prev_name, new_name);
+		for (auto &profile : profiles)
+			rename_scene_in_rules(profile, prev_name, new_name);
+		rename_scene_in_rules(rules, prev_name, new_name);
+		scenes[i] = new_name;
+		transition_decision_table renamed;
+		compile(renamed);
+	});
+
+	printf("%zu scenes, %zu rules, %zu profiles, rules %zu bytes, compiled %zu bytes, caches %zu bytes\n", scene_count,
+	       rule_count, profile_count, transition_rules_memory(rules), memory.rules + memory.index, memory.caches);
+	print_measurement("compile", compile_m);
+	print_measurement("resolve cold", cold);
+	print_measurement("resolve warm", warm);
+	print_measurement("resolve uncached", uncached);
+	print_measurement("override pass", pass);
+	print_measurement("edit", edit);
+	print_measurement("lint", lint);
+	print_measurement("rename", rename);
+	printf("%zu overrides written by %zu passes\n", written, switches);
+	return 0;
+}
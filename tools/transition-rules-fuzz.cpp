@@ -0,0 +1,474 @@
+// Property tests of the rule engine, without OBS. Random rule sets are changed by random edits, deletes and
+// renames and every step is checked:
+// - rules of scenes and Any resolve exactly like the lookup of the plugin before the decision table, from -> to,
+//   from -> Any, Any -> to, Any -> Any, through the caches and without them
+// - rules with groups, patterns, shared base rules and both precedences resolve like a lookup straight from the
+//   rules, which in turn has to agree with that lookup where both apply
+// - minimized rules resolve every pair of two different scenes like the rules they came from
+// - a to scene reached with the same transition from every other scene folds into one Any rule
+// - resolves keep matching when the caches start over
+// Every kind of check starts from the given seed, a failure prints the seed of its iteration and the step, running
+// with 1 iteration and that seed reproduces it. The exit code is 1 when anything failed.
+
+#include "transition-rules.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the lookup of the plugin before the decision table, kept as it was
+static void baseline_get_transition(const transition_rules &rules, const string &from_scene, const string &to_scene,
+				    string &transition, int &duration)
+{
+	auto fs_it = rules.find(from_scene);
+	auto as_it = rules.find("Any");
+	if (fs_it != rules.end()) {
+		auto to_it = fs_it->second.find(to_scene);
+		if (to_it == fs_it->second.end()) {
+			to_it = fs_it->second.find("Any");
+		}
+		if (to_it != fs_it->second.end()) {
+			transition = to_it->second.transition;
+			duration = to_it->second.duration;
+		}
+	}
+	if (transition.empty() && as_it != rules.end()) {
+		auto to_it = as_it->second.find(to_scene);
+		if (to_it == as_it->second.end()) {
+			to_it = as_it->second.find("Any");
+		}
+		if (to_it != as_it->second.end()) {
+			transition = to_it->second.transition;
+			duration = to_it->second.duration;
+		}
+	}
+}
+
+// Resolves straight from the rules, without the interned keys and caches of the decision table, for the
+// rules the baseline lookup does not know.
+static const transition_info *reference_cell(const transition_rules &rules, const transition_rules *base,
+					     const string &from_key, const string &to_key)
+{
+	for (const transition_rules *layer : {&rules, base}) {
+		if (!layer)
+			continue;
+		auto from_it = layer->find(from_key);
+		if (from_it == layer->end())
+			continue;
+		auto to_it = from_it->second.find(to_key);
+		if (to_it != from_it->second.end())
+			return &to_it->second;
+	}
+	return nullptr;
+}
+
+static bool glob_match(const char *glob, const char *s)
+{
+	if (*glob == '*')
+		return glob_match(glob + 1, s) || (*s && glob_match(glob, s + 1));
+	if (!*s)
+		return !*glob;
+	return (*glob == '?' || *glob == *s) && glob_match(glob + 1, s + 1);
+}
+
+static vector<string> reference_candidates(const set<string> &keys, const scene_group_table *groups,
+					   const string &sceneName)
+{
+	vector<string> result;
+	if (sceneName != "Any" && keys.count(sceneName))
+		result.push_back(sceneName);
+	if (groups) {
+		auto id_it = groups->scene_ids.find(sceneName);
+		if (id_it != groups->scene_ids.end()) {
+			for (const auto &g : groups->groups) {
+				if (keys.count(g.first) && scene_in_group(g.second, id_it->second))
+					result.push_back(g.first);
+			}
+		}
+	}
+	// "glob:" sorts before "regex:", so this is globs before regexes, both in name order
+	for (const auto &key : keys) {
+		if (sceneName.empty() || !is_scene_pattern(key))
+			continue;
+		if (key[0] == 'g') {
+			if (glob_match(key.c_str() + 5, sceneName.c_str()))
+				result.push_back(key);
+			continue;
+		}
+		try {
+			if (regex_search(sceneName, regex(key.substr(6))))
+				result.push_back(key);
+		} catch (const regex_error &) {
+		}
+	}
+	result.push_back("Any");
+	return result;
+}
+
+static const transition_info *resolve_transition_reference(const transition_rules &rules, const transition_rules *base,
+							      const scene_group_table *groups, enum rule_precedence precedence,
+							      const string &from_scene, const string &to_scene)
+{
+	set<string> keys;
+	for (const transition_rules *layer : {&rules, base}) {
+		if (!layer)
+			continue;
+		for (const auto &from : *layer) {
+			keys.insert(from.first);
+			for (const auto &to : from.second)
+				keys.insert(to.first);
+		}
+	}
+	const vector<string> from_keys = reference_candidates(keys, groups, from_scene);
+	const vector<string> to_keys = reference_candidates(keys, groups, to_scene);
+	if (precedence == RULE_PRECEDENCE_FROM_SCENE) {
+		for (const auto &from_key : from_keys) {
+			for (const auto &to_key : to_keys) {
+				const transition_info *t = reference_cell(rules, base, from_key, to_key);
+				if (!t)
+					continue;
+				if (!t->transition.empty())
+					return t;
+				break;
+			}
+		}
+		return nullptr;
+	}
+	set<string> blocked;
+	for (const auto &to_key : to_keys) {
+		for (const auto &from_key : from_keys) {
+			if (blocked.count(from_key))
+				continue;
+			const transition_info *t = reference_cell(rules, base, from_key, to_key);
+			if (!t)
+				continue;
+			if (!t->transition.empty())
+				return t;
+			blocked.insert(from_key);
+		}
+	}
+	return nullptr;
+}
+
+// the baseline has no override when the transition stays empty, the duration it keeps is not used then
+static bool same_as_baseline(const transition_info *t, const string &transition, int duration)
+{
+	if (transition.empty())
+		return !t;
+	return t && t->transition == transition && t->duration == duration;
+}
+
+static bool same_info(const transition_info *a, const transition_info *b)
+{
+	return !a == !b && (!a || *a == *b);
+}
+
+class fuzzer {
+public:
+	explicit fuzzer(uint32_t seed) : state(seed) {}
+
+	size_t checks = 0;
+	vector<string> failures;
+
+	size_t next(size_t n)
+	{
+		state = state * 1664525u + 1013904223u;
+		return (size_t)(state >> 8) % n;
+	}
+	uint32_t seed() const { return state; }
+	void reseed(uint32_t seed) { state = seed; }
+
+	void fail(uint32_t seed, size_t step, const string &what, const string &from, const string &to)
+	{
+		failures.push_back("seed " + to_string(seed) + " step " + to_string(step) + ": " + what + " '" + from +
+				   "' -> '" + to + "'");
+	}
+
+private:
+	uint32_t state;
+};
+
+static const char *const transition_names[] = {"Cut", "Fade", "Swipe"};
+
+static void set_random_rule(fuzzer &f, transition_rules &rules, const vector<string> &keys)
+{
+	// an empty transition blocks the from row like in the dialog
+	auto &t = rules[keys[f.next(keys.size())]][keys[f.next(keys.size())]];
+	t.transition = f.next(4) ? transition_names[f.next(3)] : "";
+	t.duration = (int)f.next(3) * 100;
+}
+
+static void delete_random_rule(fuzzer &f, transition_rules &rules, const vector<string> &keys)
+{
+	// like vendor_set_transition without a transition, the from row can stay empty
+	auto from_it = rules.find(keys[f.next(keys.size())]);
+	if (from_it == rules.end() || from_it->second.empty())
+		return;
+	auto to_it = from_it->second.begin();
+	std::advance(to_it, f.next(from_it->second.size()));
+	from_it->second.erase(to_it);
+}
+
+// renames to a new name or to a name the rules may still have, the scenes keep their order
+static void rename_random_scene(fuzzer &f, transition_rules &rules, scene_group_table *groups, vector<string> &scenes,
+				const vector<string> &names)
+{
+	const string prev_name = scenes[f.next(scenes.size())];
+	const string new_name = f.next(2) ? prev_name + "+" : names[f.next(names.size())];
+	if (std::find(scenes.begin(), scenes.end(), new_name) != scenes.end())
+		return;
+	rename_scene_in_rules(rules, prev_name, new_name);
+	if (groups)
+		rename_scene_in_groups(*groups, prev_name, new_name);
+	std::replace(scenes.begin(), scenes.end(), prev_name, new_name);
+}
+
+// scenes and Any only, checked against the baseline lookup
+static void fuzz_baseline(fuzzer &f, size_t iterations)
+{
+	for (size_t iteration = 0; iteration < iterations && f.failures.size() < 10; iteration++) {
+		const uint32_t seed = f.seed();
+		vector<string> scenes = {"Cam 1", "Cam 2", "S1", "S2", "Slide"};
+		vector<string> keys = scenes;
+		keys.push_back("Any");
+		// the first switch has no from scene, a scene that is gone can still be the current one
+		vector<string> from_scenes = {"", "Gone"};
+		transition_rules rules;
+		for (size_t step = 0; step < 20 && f.failures.size() < 10; step++) {
+			switch (f.next(4)) {
+			case 0:
+				delete_random_rule(f, rules, keys);
+				break;
+			case 1:
+				rename_random_scene(f, rules, nullptr, scenes, keys);
+				break;
+			default:
+				set_random_rule(f, rules, keys);
+				break;
+			}
+			transition_decision_table dt;
+			dt.compile(rules, nullptr, nullptr, RULE_PRECEDENCE_FROM_SCENE);
+			vector<pair<string, string>> pairs;
+			for (const auto &from : scenes)
+				from_scenes.push_back(from);
+			for (const auto &from : from_scenes) {
+				for (const auto &to : scenes)
+					pairs.emplace_back(from, to);
+				pairs.emplace_back(from, "Gone");
+			}
+			from_scenes.resize(2);
+			// twice in a random order, the second round comes from the resolved cache
+			bool ok = true;
+			for (size_t round = 0; round < 2 && ok; round++) {
+				for (size_t i = pairs.size(); i > 1; i--)
+					std::swap(pairs[i - 1], pairs[f.next(i)]);
+				for (const auto &p : pairs) {
+					string transition;
+					int duration = 0;
+					baseline_get_transition(rules, p.first, p.second, transition, duration);
+					f.checks++;
+					if (!same_as_baseline(dt.resolve(p.first, p.second), transition, duration))
+						f.fail(seed, step, "resolve differs from the baseline", p.first, p.second);
+					else if (!same_as_baseline(dt.resolve_uncached(p.first, p.second), transition, duration))
+						f.fail(seed, step, "uncached resolve differs from the baseline", p.first, p.second);
+					else if (!same_as_baseline(resolve_transition_reference(rules, nullptr, nullptr,
+												RULE_PRECEDENCE_FROM_SCENE,
+												p.first, p.second),
+								   transition, duration))
+						f.fail(seed, step, "reference differs from the baseline", p.first, p.second);
+					else
+						continue;
+					ok = false;
+					break;
+				}
+			}
+			// later steps build on the failing one
+			if (!ok)
+				break;
+		}
+	}
+}
+
+// groups, patterns, base rules and both precedences, checked against the reference and minimized rules
+static void fuzz_reference(fuzzer &f, size_t iterations)
+{
+	// the first five are scene names, "regex:(" does not compile
+	static const vector<string> keys = {"Cam 1",   "Cam 2",   "S1",        "S2",      "Slide",          "Any",
+					    "group:A", "group:B", "glob:Cam*", "glob:S?", "regex:^S\\d$", "regex:(",
+					    "regex:lide"};
+	for (size_t iteration = 0; iteration < iterations && f.failures.size() < 10; iteration++) {
+		const uint32_t seed = f.seed();
+		vector<string> scenes = {"Cam 1", "Cam 2", "S1", "S2", "Slide", "Other"};
+		transition_rules rules;
+		transition_rules base;
+		const bool has_base = f.next(2);
+		const enum rule_precedence precedence = f.next(2) ? RULE_PRECEDENCE_FROM_SCENE : RULE_PRECEDENCE_TO_SCENE;
+		scene_group_table groups;
+		for (const char *group : {"group:A", "group:B"})
+			groups.groups[group];
+		for (size_t step = 0; step < 20 && f.failures.size() < 10; step++) {
+			switch (f.next(5)) {
+			case 0:
+				set_random_rule(f, has_base && f.next(3) == 0 ? base : rules, keys);
+				break;
+			case 1:
+				delete_random_rule(f, rules, keys);
+				break;
+			case 2:
+				rename_random_scene(f, rules, &groups, scenes, vector<string>(keys.begin(), keys.begin() + 5));
+				break;
+			default: {
+				auto &members = groups.groups[f.next(2) ? "group:A" : "group:B"];
+				const size_t id = intern_group_scene(groups, scenes[f.next(scenes.size())]);
+				if (members.size() <= id / 64)
+					members.resize(id / 64 + 1);
+				members[id / 64] ^= (uint64_t)1 << (id % 64);
+				break;
+			}
+			}
+			const transition_rules *base_rules = has_base ? &base : nullptr;
+			transition_decision_table dt;
+			dt.compile(rules, base_rules, &groups, precedence);
+			vector<string> from_scenes = scenes;
+			from_scenes.push_back(string());
+			bool ok = true;
+			for (const auto &from : from_scenes) {
+				for (const auto &to : scenes) {
+					f.checks++;
+					if (same_info(dt.resolve(from, to),
+						      resolve_transition_reference(rules, base_rules, &groups, precedence, from, to)))
+						continue;
+					f.fail(seed, step, "resolve differs from the reference", from, to);
+					ok = false;
+					break;
+				}
+				if (!ok)
+					break;
+			}
+			if (!ok)
+				break;
+			if (step % 5 != 4)
+				continue;
+			minimize_result result;
+			const transition_rules minimized =
+				minimize_transition_rules(rules, base_rules, &groups, precedence, scenes, result);
+			transition_decision_table minimized_dt;
+			minimized_dt.compile(minimized, base_rules, &groups, precedence);
+			for (const auto &from : scenes) {
+				for (const auto &to : scenes) {
+					if (from == to)
+						continue;
+					f.checks++;
+					if (same_info(minimized_dt.resolve(from, to), dt.resolve(from, to)))
+						continue;
+					f.fail(seed, step, "minimized rules resolve differently", from, to);
+					ok = false;
+					break;
+				}
+				if (!ok)
+					break;
+			}
+			if (!ok)
+				break;
+		}
+	}
+}
+
+// more scenes than the caches keep, they start over while the table is in use
+static void fuzz_cache_limits(fuzzer &f)
+{
+	const uint32_t seed = f.seed();
+	transition_rules rules;
+	rules["Any"]["Any"] = {"Fade", 300};
+	rules["Any"]["Cam 1"] = {"Cut", 0};
+	rules["Cam 1"]["Any"] = {"Swipe", 500};
+	rules["Cam 2"]["Any"] = {"", 0};
+	transition_decision_table dt;
+	dt.compile(rules, nullptr, nullptr, RULE_PRECEDENCE_FROM_SCENE);
+	const vector<string> known = {"Cam 1", "Cam 2", "Any"};
+	for (size_t i = 0; i < 40000; i++) {
+		const string from = f.next(2) ? known[f.next(known.size())] : "Scene " + to_string(f.next(30000));
+		const string to = f.next(2) ? known[f.next(known.size())] : "Scene " + to_string(f.next(30000));
+		string transition;
+		int duration = 0;
+		baseline_get_transition(rules, from, to, transition, duration);
+		f.checks++;
+		if (same_as_baseline(dt.resolve(from, to), transition, duration))
+			continue;
+		f.fail(seed, i, "resolve differs from the baseline after the caches filled", from, to);
+		break;
+	}
+}
+
+// columns that every other scene shares fold into an Any rule, the rules they came from are removed
+static void check_minimize_folds(fuzzer &f)
+{
+	const uint32_t seed = f.seed();
+	vector<string> scenes;
+	for (size_t i = 0; i < 5; i++)
+		scenes.push_back("Scene " + to_string(i + 1));
+	auto check = [&](size_t step, const transition_rules &rules, const transition_rules &want, size_t folded,
+			 size_t removed) {
+		minimize_result result;
+		const transition_rules minimized =
+			minimize_transition_rules(rules, nullptr, nullptr, RULE_PRECEDENCE_FROM_SCENE, scenes, result);
+		f.checks++;
+		if (minimized != want || result.folded != folded || result.removed != removed)
+			f.fail(seed, step,
+			       "minimize folded " + to_string(result.folded) + " and removed " + to_string(result.removed),
+			       scenes.front(), scenes.back());
+	};
+
+	// one to scene reached with the same transition from every other scene
+	transition_rules rules;
+	for (size_t i = 1; i < scenes.size(); i++)
+		rules[scenes[i]][scenes[0]] = {"Fade", 300};
+	transition_rules want;
+	want["Any"][scenes[0]] = {"Fade", 300};
+	check(0, rules, want, 1, scenes.size() - 1);
+
+	// every pair the same, each column folds on its own
+	rules.clear();
+	want.clear();
+	for (const auto &from : scenes) {
+		for (const auto &to : scenes) {
+			if (from != to)
+				rules[from][to] = {"Fade", 300};
+		}
+		want["Any"][from] = {"Fade", 300};
+	}
+	check(1, rules, want, scenes.size(), scenes.size() * (scenes.size() - 1));
+
+	// a column with a different transition from one scene still folds to the most common one
+	rules[scenes[2]][scenes[0]] = {"Cut", 0};
+	transition_rules mixed = want;
+	mixed[scenes[2]][scenes[0]] = {"Cut", 0};
+	check(2, rules, mixed, scenes.size(), scenes.size() * (scenes.size() - 1) - 1);
+}
+
+int main(int argc, char **argv)
+{
+	const size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200;
+	const uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 1;
+	if (argc > 3 || !iterations) {
+		fputs("usage: transition-rules-fuzz [<iterations> [<seed>]]\n", stderr);
+		return 2;
+	}
+	fuzzer f(seed);
+	fuzz_baseline(f, iterations);
+	f.reseed(seed);
+	fuzz_reference(f, iterations);
+	f.reseed(seed);
+	fuzz_cache_limits(f);
+	f.reseed(seed);
+	check_minimize_folds(f);
+	for (const auto &failure : f.failures)
+		fprintf(stderr, "%s\n", failure.c_str());
+	printf("%zu checks, %zu failures\n", f.checks, f.failures.size());
+	return f.failures.empty() ? 0 : 1;
+}
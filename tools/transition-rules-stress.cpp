@@ -0,0 +1,590 @@
+// Stress test of how the plugin shares the rule engine between threads, without OBS. The plugin keeps its rules and
+// compiled tables on the UI thread through transition-threads: websocket requests and proc handlers wait for it with
+// run_on_ui_thread, signals, hotkeys and the graphics thread queue their work with queue_on_ui_thread, and every
+// function that touches the tables checks on_ui_thread. Here that same code runs on a stand-in event loop instead of
+// Qt, which owns two canvases while websocket, signal and graphics threads hammer it. Minimize runs on the requesting
+// thread from a snapshot and the lint reads copies on a worker, like in the plugin.
+// Built with -DTRANSITION_TABLE_SANITIZER=thread, ThreadSanitizer reports every access that escapes the UI thread,
+// the checks here report lost and stale work:
+// - rules a websocket thread set resolve to what it set, through the caches and without them
+// - every queued task runs, the graphics thread is refused by run_on_ui_thread and never waits for the UI thread
+// - no function that touches the tables is called outside the UI thread, and one that is gets nothing
+// - a minimize is only applied over the rules it was computed from
+// - the overrides after the last pass match a freshly compiled table
+// The exit code is 1 when anything failed.
+
+#include "transition-rules.hpp"
+#include "transition-threads.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static atomic<size_t> failures{0};
+static mutex output_mutex;
+
+static void fail(const string &what)
+{
+	failures++;
+	lock_guard<mutex> lock(output_mutex);
+	fprintf(stderr, "%s\n", what.c_str());
+}
+
+// what obs_in_task_thread(OBS_TASK_GRAPHICS) tells the plugin
+static thread_local bool graphics_thread = false;
+// counts the errors a thread expects to be logged, any other error is a failure
+static thread_local size_t *expected_errors = nullptr;
+
+// the Qt event loop the plugin hands its work to
+class event_loop {
+public:
+	event_loop() : worker([this] { loop(); }) {}
+
+	bool on_thread() const { return this_thread::get_id() == worker.get_id(); }
+
+	// like obs_queue_task
+	void post(function<void()> f)
+	{
+		queued++;
+		lock_guard<mutex> lock(m);
+		tasks.push_back([this, f = std::move(f)] {
+			f();
+			executed++;
+		});
+		cv.notify_one();
+	}
+
+	// like QMetaObject::invokeMethod with Qt::BlockingQueuedConnection
+	void invoke(const function<void()> &f)
+	{
+		bool done = false;
+		condition_variable done_cv;
+		unique_lock<mutex> lock(m);
+		tasks.push_back([&] {
+			f();
+			lock_guard<mutex> done_lock(m);
+			done = true;
+			done_cv.notify_one();
+		});
+		cv.notify_one();
+		done_cv.wait(lock, [&done] { return done; });
+	}
+
+	// runs what is still queued first
+	void stop()
+	{
+		{
+			lock_guard<mutex> lock(m);
+			stopping = true;
+		}
+		cv.notify_one();
+		worker.join();
+	}
+
+	atomic<size_t> queued{0};
+	size_t executed = 0;
+
+private:
+	void loop()
+	{
+		unique_lock<mutex> lock(m);
+		for (;;) {
+			cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+			if (tasks.empty())
+				return;
+			auto f = std::move(tasks.front());
+			tasks.pop_front();
+			lock.unlock();
+			f();
+			lock.lock();
+		}
+	}
+
+	mutex m;
+	condition_variable cv;
+	deque<function<void()>> tasks;
+	bool stopping = false;
+	thread worker;
+};
+
+static event_loop *ui = nullptr;
+
+// what the plugin gets from OBS and Qt
+static const ui_thread_host stress_host = {
+	[] { return ui->on_thread(); },
+	[] { return graphics_thread; },
+	[](function<void()> f) { ui->post(std::move(f)); },
+	[](const function<void()> &f) {
+		ui->invoke(f);
+		return true;
+	},
+	[](const char *message) {
+		if (expected_errors)
+			(*expected_errors)++;
+		else
+			fail(message);
+	},
+};
+
+static const size_t scene_count = 64;
+// scenes below are edited by the websocket threads, the ones above are renamed by the signal threads
+static const size_t owned_scenes = 48;
+static const size_t websocket_threads = 4;
+static const size_t signal_threads = 2;
+
+static string scene_name(size_t i)
+{
+	return "Scene " + to_string(i);
+}
+
+static string renamed_name(size_t i)
+{
+	return "Renamed " + to_string(i);
+}
+
+// a canvas of the plugin, only touched on the UI thread
+struct stress_canvas {
+	transition_rules rules;
+	scene_group_table groups;
+	vector<string> scenes;
+	unique_ptr<transition_decision_table> table;
+	string current_scene;
+	map<string, transition_info> overrides;
+	// the rules of the other profile, swapped in by switch_profile
+	transition_rules other_profile;
+	unique_ptr<transition_decision_table> other_table;
+};
+
+// what the lint worker gets of a canvas, shared with the UI thread and never changed
+struct lint_input {
+	shared_ptr<const transition_rules> rules;
+	shared_ptr<const scene_group_table> groups;
+	shared_ptr<const vector<string>> scenes;
+};
+
+static map<string, stress_canvas> canvases;
+static map<string, lint_input> lint_inputs;
+static size_t lint_runs = 0;
+static size_t lint_issues = 0;
+
+// the lint worker, like run_lint it only sees copies and posts its results to the UI thread
+static mutex lint_mutex;
+static condition_variable lint_cv;
+static map<string, lint_input> lint_pending;
+static bool lint_has_pending = false;
+static bool lint_stopping = false;
+
+static void lint_loop()
+{
+	const vector<string> transitions = {"Cut", "Fade", "Stinger"};
+	unique_lock<mutex> lock(lint_mutex);
+	for (;;) {
+		lint_cv.wait(lock, [] { return lint_stopping || lint_has_pending; });
+		if (!lint_has_pending)
+			return;
+		map<string, lint_input> inputs = std::move(lint_pending);
+		lint_pending.clear();
+		lint_has_pending = false;
+		lock.unlock();
+		size_t issues = 0;
+		for (const auto &it : inputs) {
+			issues += lint_transition_rules(*it.second.rules, nullptr, it.second.groups.get(), RULE_PRECEDENCE_FROM_SCENE,
+							*it.second.scenes, transitions)
+					  .size();
+			for (const auto &other : inputs) {
+				if (other.first == it.first)
+					continue;
+				const set<string> scenes(it.second.scenes->begin(), it.second.scenes->end());
+				const set<string> other_scenes(other.second.scenes->begin(), other.second.scenes->end());
+				issues += lint_cross_canvas_pair(*it.second.rules, scenes, other.first, *other.second.rules,
+								 other_scenes)
+						  .size();
+			}
+		}
+		queue_on_ui_thread([issues] {
+			lint_runs++;
+			lint_issues += issues;
+		});
+		lock.lock();
+	}
+}
+
+// like transition_table_changed, the compiled table is dropped and the lint gets new copies
+static void canvas_changed(const string &canvasName)
+{
+	if (!on_ui_thread(__func__))
+		return;
+	auto &sc = canvases[canvasName];
+	sc.table.reset();
+	lint_inputs[canvasName] = {make_shared<const transition_rules>(sc.rules),
+				   make_shared<const scene_group_table>(sc.groups),
+				   make_shared<const vector<string>>(sc.scenes)};
+	lock_guard<mutex> lock(lint_mutex);
+	lint_pending = lint_inputs;
+	lint_has_pending = true;
+	lint_cv.notify_one();
+}
+
+// like find_resolve_table and get_decision_table, nullptr outside the UI thread
+static transition_decision_table *get_table(stress_canvas &sc)
+{
+	if (!on_ui_thread(__func__))
+		return nullptr;
+	if (!sc.table) {
+		sc.table = make_unique<transition_decision_table>();
+		sc.table->compile(sc.rules, nullptr, &sc.groups, RULE_PRECEDENCE_FROM_SCENE);
+	}
+	return sc.table.get();
+}
+
+// like set_transition_overrides_queued
+static void override_pass(stress_canvas &sc)
+{
+	auto dt = get_table(sc);
+	if (!dt)
+		return;
+	for (const auto &sceneName : sc.scenes) {
+		const transition_info *t = dt->resolve(sc.current_scene, sceneName);
+		if (!t)
+			sc.overrides.erase(sceneName);
+		else
+			sc.overrides[sceneName] = *t;
+	}
+}
+
+static void add_to_group(scene_group_table &groups, const string &group, const string &sceneName)
+{
+	auto &members = groups.groups[group];
+	const size_t id = intern_group_scene(groups, sceneName);
+	if (members.size() <= id / 64)
+		members.resize(id / 64 + 1);
+	members[id / 64] |= (uint64_t)1 << (id % 64);
+}
+
+static void setup_canvas(const string &canvasName, uint32_t seed)
+{
+	auto &sc = canvases[canvasName];
+	uint32_t state = seed;
+	auto next = [&state] {
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	};
+	const char *names[] = {"Cut", "Fade", "Stinger"};
+	for (size_t i = 0; i < scene_count; i++) {
+		sc.scenes.push_back(scene_name(i));
+		if (i % 5 == 0)
+			add_to_group(sc.groups, "group:Cameras", sc.scenes.back());
+	}
+	for (size_t i = 0; i < scene_count; i++) {
+		for (size_t j = 0; j < scene_count; j++) {
+			if (i != j && next() % 20 == 0)
+				sc.rules[scene_name(i)][scene_name(j)] = {names[next() % 3], (int)(next() % 1000)};
+		}
+	}
+	sc.rules["Any"]["Any"] = {"Fade", 300};
+	sc.rules["group:Cameras"]["Any"] = {"Cut", 0};
+	sc.rules["glob:Renamed *"]["Any"] = {"Stinger", 700};
+	sc.other_profile = sc.rules;
+	sc.other_profile["Any"]["Any"] = {"Cut", 0};
+	sc.current_scene = sc.scenes[0];
+	canvas_changed(canvasName);
+}
+
+// like switch_profile, the rules and the compiled table are swapped without a recompile
+static void switch_profile(const string &canvasName)
+{
+	if (!on_ui_thread(__func__))
+		return;
+	auto &sc = canvases[canvasName];
+	swap(sc.rules, sc.other_profile);
+	swap(sc.table, sc.other_table);
+}
+
+// like rename_scene, through the rules, the other profile, the groups and the overrides of every canvas
+static void rename_scene(const string &prev_name, const string &new_name)
+{
+	if (!on_ui_thread(__func__))
+		return;
+	for (auto &it : canvases) {
+		auto &sc = it.second;
+		rename_scene_in_rules(sc.rules, prev_name, new_name);
+		rename_scene_in_rules(sc.other_profile, prev_name, new_name);
+		rename_scene_in_groups(sc.groups, prev_name, new_name);
+		sc.other_table.reset();
+		for (auto &sceneName : sc.scenes) {
+			if (sceneName == prev_name)
+				sceneName = new_name;
+		}
+		if (sc.current_scene == prev_name)
+			sc.current_scene = new_name;
+		auto o = sc.overrides.find(prev_name);
+		if (o != sc.overrides.end()) {
+			sc.overrides[new_name] = o->second;
+			sc.overrides.erase(o);
+		}
+		canvas_changed(it.first);
+	}
+}
+
+using pair_key = pair<size_t, size_t>;
+
+// vendor_ui_request and the proc handlers, the websocket threads are never refused
+static void request(const function<void()> &f)
+{
+	if (!run_on_ui_thread(f))
+		fail("run_on_ui_thread refused a websocket request");
+}
+
+// each websocket thread sets rules from its own scenes on the main canvas and checks they resolve
+static void websocket_thread(size_t index, size_t operations, uint32_t seed, map<pair_key, transition_info> &expected)
+{
+	uint32_t state = seed * 7919u + (uint32_t)index;
+	auto next = [&state] {
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	};
+	auto owned_scene = [&] {
+		return (next() % (owned_scenes / websocket_threads)) * websocket_threads + index;
+	};
+	for (size_t op = 0; op < operations; op++) {
+		const uint32_t kind = next() % 10;
+		if (kind < 4) {
+			// get_transition, of a pair this thread set when there is one
+			pair_key key{owned_scene(), next() % owned_scenes};
+			if (!expected.empty() && next() % 2) {
+				auto it = expected.begin();
+				std::advance(it, next() % expected.size());
+				key = it->first;
+			}
+			auto it = expected.find(key);
+			request([&] {
+				auto dt = get_table(canvases["Main"]);
+				if (!dt)
+					return;
+				const transition_info *t = dt->resolve(scene_name(key.first), scene_name(key.second));
+				const transition_info *uncached = dt->resolve_uncached(scene_name(key.first), scene_name(key.second));
+				if (t != uncached)
+					fail("resolve differs from resolve_uncached for " + scene_name(key.first) + " -> " +
+					     scene_name(key.second));
+				if (it != expected.end() && (!t || *t != it->second))
+					fail("websocket thread " + to_string(index) + " lost its rule " + scene_name(key.first) + " -> " +
+					     scene_name(key.second));
+			});
+		} else if (kind < 6) {
+			// set_transition
+			const pair_key key{owned_scene(), next() % owned_scenes};
+			if (key.first == key.second)
+				continue;
+			const transition_info info{"Fade", (int)(index * operations + op)};
+			request([&] {
+				canvases["Main"].rules[scene_name(key.first)][scene_name(key.second)] = info;
+				canvas_changed("Main");
+			});
+			expected[key] = info;
+		} else if (kind < 7) {
+			// prepare_switch, only the override of the target scene is written
+			const string canvasName = next() % 2 ? "Main" : "Profiles";
+			const size_t to = next() % owned_scenes;
+			request([&] {
+				auto &sc = canvases[canvasName];
+				auto dt = get_table(sc);
+				if (!dt)
+					return;
+				const transition_info *t = dt->resolve(sc.current_scene, scene_name(to));
+				if (t)
+					sc.overrides[scene_name(to)] = *t;
+				else
+					sc.overrides.erase(scene_name(to));
+			});
+		} else if (kind < 9) {
+			// the switch_profile proc handler
+			request([] { switch_profile("Profiles"); });
+		} else {
+			// minimize, computed here from a snapshot like vendor_minimize
+			transition_rules rules;
+			scene_group_table groups;
+			vector<string> scenes;
+			request([&] {
+				auto &sc = canvases["Main"];
+				rules = sc.rules;
+				groups = sc.groups;
+				scenes = sc.scenes;
+			});
+			minimize_result result;
+			const transition_rules minimized = minimize_transition_rules(
+				rules, nullptr, &groups, RULE_PRECEDENCE_FROM_SCENE, scenes, result, nullptr);
+			transition_decision_table before, after;
+			before.compile(rules, nullptr, &groups, RULE_PRECEDENCE_FROM_SCENE);
+			after.compile(minimized, nullptr, &groups, RULE_PRECEDENCE_FROM_SCENE);
+			for (size_t i = 0; i < 200; i++) {
+				const string &from = scenes[next() % scenes.size()];
+				const string &to = scenes[next() % scenes.size()];
+				// OBS never transitions from a scene to itself, minimize leaves those pairs out
+				if (from == to)
+					continue;
+				const transition_info *a = before.resolve_uncached(from, to);
+				const transition_info *b = after.resolve_uncached(from, to);
+				if ((a == nullptr) != (b == nullptr) || (a && *a != *b))
+					fail("minimized rules resolve " + from + " -> " + to + " differently");
+			}
+			request([&] {
+				// like snapshot_current, edits made while minimizing are not overwritten
+				auto &sc = canvases["Main"];
+				if (sc.rules != rules || sc.groups.groups != groups.groups || sc.groups.scene_names != groups.scene_names)
+					return;
+				sc.rules = minimized;
+				canvas_changed("Main");
+			});
+		}
+	}
+}
+
+// channel_change and source_rename, queued like the plugin does from its signal handlers
+static void signal_thread(size_t index, size_t operations, uint32_t seed)
+{
+	uint32_t state = seed * 104729u + (uint32_t)index;
+	auto next = [&state] {
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	};
+	set<size_t> renamed;
+	for (size_t op = 0; op < operations; op++) {
+		if (next() % 2) {
+			const string canvasName = next() % 2 ? "Main" : "Profiles";
+			const size_t scene = next() % scene_count;
+			queue_on_ui_thread([canvasName, scene] {
+				auto &sc = canvases[canvasName];
+				sc.current_scene = sc.scenes[scene];
+				override_pass(sc);
+			});
+			continue;
+		}
+		// only the scenes of this thread, so it knows their names
+		const size_t scene = owned_scenes + (next() % ((scene_count - owned_scenes) / signal_threads)) * signal_threads + index;
+		const bool was_renamed = renamed.count(scene) != 0;
+		const string prev_name = was_renamed ? renamed_name(scene) : scene_name(scene);
+		const string new_name = was_renamed ? scene_name(scene) : renamed_name(scene);
+		if (was_renamed)
+			renamed.erase(scene);
+		else
+			renamed.insert(scene);
+		queue_on_ui_thread([prev_name, new_name] { rename_scene(prev_name, new_name); });
+	}
+}
+
+// transition_start queues its pass, the graphics thread may never wait for the UI thread
+static void graphics_thread_main(size_t operations, uint32_t seed)
+{
+	graphics_thread = true;
+	size_t refused = 0;
+	expected_errors = &refused;
+	size_t waits = 0;
+	uint32_t state = seed * 15485863u;
+	for (size_t op = 0; op < operations; op++) {
+		state = state * 1664525u + 1013904223u;
+		const string canvasName = (state >> 8) % 2 ? "Main" : "Profiles";
+		queue_on_ui_thread([canvasName] { override_pass(canvases[canvasName]); });
+		if (op % 100 != 0)
+			continue;
+		waits++;
+		if (run_on_ui_thread([] {}))
+			fail("the graphics thread waited for the UI thread");
+	}
+	if (refused != waits)
+		fail("run_on_ui_thread refused the graphics thread " + to_string(refused) + " of " + to_string(waits) +
+		     " times without logging it");
+	expected_errors = nullptr;
+}
+
+int main(int argc, char **argv)
+{
+	const size_t operations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+	const uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 1;
+	if (argc > 3 || !operations) {
+		fputs("usage: transition-rules-stress [<operations> [<seed>]]\n"
+		      "Every websocket, signal and graphics thread makes that many requests.\n",
+		      stderr);
+		return 2;
+	}
+
+	event_loop main_ui;
+	ui = &main_ui;
+	set_ui_thread_host(&stress_host);
+	thread lint_worker(lint_loop);
+	request([seed] {
+		setup_canvas("Main", seed);
+		setup_canvas("Profiles", seed + 1);
+	});
+
+	vector<map<pair_key, transition_info>> expected(websocket_threads);
+	vector<thread> threads;
+	for (size_t i = 0; i < websocket_threads; i++)
+		threads.emplace_back(websocket_thread, i, operations, seed, std::ref(expected[i]));
+	for (size_t i = 0; i < signal_threads; i++)
+		threads.emplace_back(signal_thread, i, operations, seed);
+	threads.emplace_back(graphics_thread_main, operations, seed);
+	for (auto &t : threads)
+		t.join();
+
+	{
+		lock_guard<mutex> lock(lint_mutex);
+		lint_stopping = true;
+	}
+	lint_cv.notify_one();
+	lint_worker.join();
+
+	// a function that touches the tables gets nothing outside the UI thread
+	{
+		size_t refused = 0;
+		expected_errors = &refused;
+		stress_canvas outside;
+		if (get_table(outside) || refused != 1)
+			fail("get_table ran outside the UI thread");
+		expected_errors = nullptr;
+	}
+
+	size_t checked = 0;
+	request([&] {
+		for (auto &it : canvases) {
+			auto &sc = it.second;
+			override_pass(sc);
+			transition_decision_table fresh;
+			fresh.compile(sc.rules, nullptr, &sc.groups, RULE_PRECEDENCE_FROM_SCENE);
+			for (const auto &sceneName : sc.scenes) {
+				const transition_info *t = fresh.resolve_uncached(sc.current_scene, sceneName);
+				auto o = sc.overrides.find(sceneName);
+				if ((o == sc.overrides.end()) != (t == nullptr) || (t && o->second != *t))
+					fail(it.first + ": stale override for " + sceneName);
+				checked++;
+			}
+		}
+		auto dt = get_table(canvases["Main"]);
+		for (const auto &thread_expected : expected) {
+			for (const auto &e : thread_expected) {
+				const transition_info *t = dt->resolve(scene_name(e.first.first), scene_name(e.first.second));
+				if (!t || *t != e.second)
+					fail("lost rule " + scene_name(e.first.first) + " -> " + scene_name(e.first.second));
+				checked++;
+			}
+		}
+	});
+	main_ui.stop();
+	set_ui_thread_host(nullptr);
+	if (main_ui.executed != main_ui.queued)
+		fail(to_string(main_ui.queued - main_ui.executed) + " of " + to_string(main_ui.queued) + " queued tasks never ran");
+
+	printf("%zu threads, %zu queued tasks, %zu lint runs with %zu issues, %zu final checks, %zu failures\n",
+	       threads.size() + 2, (size_t)main_ui.queued, lint_runs, lint_issues, checked, (size_t)failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,685 @@
+// Works on the transition tables of scene collections without OBS: prints statistics, validates the
+// rules against the scenes of the collection, converts between the export and a compact format and
+// diffs or merges tables. Scene collections are streamed, only the sections with the tables, the
+// scenes and the transitions are kept in memory.
+
+#include "json-reader.hpp"
+#include "transition-rules.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct canvas_options {
+	enum rule_precedence precedence = RULE_PRECEDENCE_FROM_SCENE;
+	string shared_rules;
+};
+
+struct collection {
+	// where the rules came from, for the statistics
+	string format;
+	// canvas or "shared:<name>" -> rules
+	map<string, transition_rules> tables;
+	// canvas -> profile -> rules
+	map<string, map<string, transition_rules>> profiles;
+	map<string, scene_group_table> groups;
+	map<string, canvas_options> options;
+	map<string, string> linked_files;
+	// canvas -> scenes, only known for scene collections
+	map<string, vector<string>> scenes;
+	vector<string> transitions;
+	// rules that were in the file more than once, the last one is kept
+	size_t duplicates = 0;
+};
+
+struct source_entry {
+	string name;
+	string canvas_uuid;
+	string transition;
+	int duration = 0;
+};
+
+static string main_canvas = "Main";
+
+static void add_rule(collection &c, transition_rules &rules, const string &from_scene, const string &to_scene,
+		     const transition_info &info)
+{
+	auto &to = rules[from_scene];
+	if (!to.emplace(to_scene, info).second) {
+		to[to_scene] = info;
+		c.duplicates++;
+	}
+}
+
+static void read_rules(collection &c, const vector<json_value> &transitions, const string &canvas,
+		       map<string, transition_rules> &tables)
+{
+	for (const auto &t : transitions) {
+		string rule_canvas = t.get_string("canvas");
+		if (rule_canvas.empty())
+			rule_canvas = canvas;
+		add_rule(c, tables[rule_canvas], t.get_string("from_scene"), t.get_string("to_scene"),
+			 {t.get_string("transition"), (int)t.get_int("duration")});
+	}
+}
+
+static void load_transition_table(collection &c, const json_value &obj)
+{
+	c.format = "transition-table";
+	read_rules(c, obj.get_array("transitions"), main_canvas, c.tables);
+	for (const auto &setting : obj.get_array("canvas_settings")) {
+		auto &options = c.options[setting.get_string("canvas")];
+		options.precedence = (enum rule_precedence)setting.get_int("precedence");
+		options.shared_rules = setting.get_string("shared_rules");
+	}
+	for (const auto &profile : obj.get_array("profiles")) {
+		map<string, transition_rules> tables;
+		read_rules(c, profile.get_array("transitions"), profile.get_string("canvas"), tables);
+		c.profiles[profile.get_string("canvas")][profile.get_string("name")] = tables[profile.get_string("canvas")];
+	}
+	for (const auto &group : obj.get_array("groups")) {
+		string canvas = group.get_string("canvas");
+		if (canvas.empty())
+			canvas = main_canvas;
+		auto &sgt = c.groups[canvas];
+		vector<uint64_t> members;
+		for (const auto &scene : group.get_array("scenes")) {
+			const size_t id = intern_group_scene(sgt, scene.get_string("name"));
+			if (members.size() <= id / 64)
+				members.resize(id / 64 + 1);
+			members[id / 64] |= (uint64_t)1 << (id % 64);
+		}
+		sgt.groups["group:" + group.get_string("name")] = std::move(members);
+	}
+	for (const auto &file : obj.get_array("linked_files"))
+		c.linked_files[file.get_string("canvas")] = file.get_string("file");
+}
+
+static void load_transition_matrix(collection &c, const json_value &obj)
+{
+	c.format = "obs-transition-matrix";
+	for (const auto &transition : obj.get_array("matrix")) {
+		const string from_scene = transition.get_string("scene");
+		for (const auto &to : transition.get_array("data")) {
+			const string to_scene = to.get_string("to");
+			if (!from_scene.empty() && !to_scene.empty())
+				add_rule(c, c.tables[main_canvas], from_scene, to_scene,
+					 {to.get_string("transition"), (int)to.get_int("duration")});
+		}
+	}
+}
+
+static bool read_source(json_reader &reader, source_entry &source, bool &is_scene)
+{
+	if (!reader.is_object())
+		return reader.skip_value();
+	reader.begin_object();
+	bool first = true;
+	string key, value;
+	while (reader.next_key(key, first)) {
+		if (key == "id") {
+			if (!reader.read_string(value))
+				return false;
+			is_scene = value == "scene";
+		} else if (key == "name") {
+			if (!reader.read_string(source.name))
+				return false;
+		} else if (key == "canvas_uuid") {
+			if (!reader.read_string(source.canvas_uuid))
+				return false;
+		} else if (key == "private_settings" && reader.is_object()) {
+			json_value settings;
+			if (!reader.read_value(settings))
+				return false;
+			source.transition = settings.get_string("transition");
+			source.duration = (int)settings.get_int("transition_duration");
+		} else if (!reader.skip_value()) {
+			return false;
+		}
+	}
+	return reader.error().empty();
+}
+
+static bool read_collection(const char *path, collection &c, string &error)
+{
+	FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+	if (!file) {
+		error = "cannot open file";
+		return false;
+	}
+	json_reader reader(file);
+	vector<source_entry> sources;
+	// canvas uuid -> name
+	map<string, string> canvases;
+	vector<string> names;
+	vector<vector<long long>> compact_rules;
+	bool has_table = false;
+	// only used when there is no transition-table module, which can come after it
+	bool has_matrix = false;
+	json_value matrix;
+	bool ok = reader.begin_object();
+	bool first = true;
+	string key;
+	while (ok && reader.next_key(key, first)) {
+		if (key == "modules" && reader.is_object()) {
+			reader.begin_object();
+			bool first_module = true;
+			string module;
+			while (ok && reader.next_key(module, first_module)) {
+				if (module == "transition-table") {
+					json_value obj;
+					ok = reader.read_value(obj);
+					has_table = true;
+					load_transition_table(c, obj);
+				} else if (module == "obs-transition-matrix") {
+					has_matrix = true;
+					ok = reader.read_value(matrix);
+				} else {
+					ok = reader.skip_value();
+				}
+			}
+		} else if (key == "sources" && reader.is_array()) {
+			reader.begin_array();
+			bool first_item = true;
+			while (ok && reader.next_item(first_item)) {
+				source_entry source;
+				bool is_scene = false;
+				ok = read_source(reader, source, is_scene);
+				if (is_scene)
+					sources.push_back(std::move(source));
+			}
+		} else if (key == "canvases" && reader.is_array()) {
+			json_value array;
+			ok = reader.read_value(array);
+			for (const auto &canvas : array.items)
+				canvases[canvas.get_string("uuid")] = canvas.get_string("name");
+		} else if (key == "transitions" && reader.is_array()) {
+			// the transitions of a scene collection or the rules of an exported table
+			reader.begin_array();
+			bool first_item = true;
+			while (ok && reader.next_item(first_item)) {
+				json_value item;
+				ok = reader.read_value(item);
+				if (item.get("from_scene")) {
+					c.format = "export";
+					string canvas = item.get_string("canvas");
+					if (canvas.empty())
+						canvas = main_canvas;
+					add_rule(c, c.tables[canvas], item.get_string("from_scene"), item.get_string("to_scene"),
+						 {item.get_string("transition"), (int)item.get_int("duration")});
+				} else if (!item.get_string("name").empty()) {
+					c.transitions.push_back(item.get_string("name"));
+				}
+			}
+		} else if (key == "names" && reader.is_array()) {
+			json_value array;
+			ok = reader.read_value(array);
+			for (const auto &name : array.items)
+				names.push_back(name.str);
+		} else if (key == "rules" && reader.is_array()) {
+			json_value array;
+			ok = reader.read_value(array);
+			for (const auto &rule : array.items) {
+				vector<long long> ids;
+				for (const auto &id : rule.items)
+					ids.push_back((long long)id.number);
+				compact_rules.push_back(std::move(ids));
+			}
+		} else {
+			ok = reader.skip_value();
+		}
+	}
+	if (ok && !reader.at_end())
+		ok = false;
+	if (file != stdin)
+		fclose(file);
+	if (!ok) {
+		error = reader.error().empty() ? "invalid json" : reader.error();
+		return false;
+	}
+
+	// [canvas, from scene, to scene, transition, duration], all but the duration index names
+	if (!compact_rules.empty()) {
+		c.format = "compact";
+		for (const auto &rule : compact_rules) {
+			bool valid = rule.size() == 5;
+			for (size_t i = 0; valid && i < 4; i++)
+				valid = rule[i] >= 0 && (size_t)rule[i] < names.size();
+			if (!valid) {
+				error = "invalid compact rule";
+				return false;
+			}
+			add_rule(c, c.tables[names[rule[0]]], names[rule[1]], names[rule[2]], {names[rule[3]], (int)rule[4]});
+		}
+	}
+	if (has_matrix && !has_table)
+		load_transition_matrix(c, matrix);
+	for (const auto &source : sources) {
+		auto canvas_it = canvases.find(source.canvas_uuid);
+		const string &canvas = canvas_it == canvases.end() ? main_canvas : canvas_it->second;
+		c.scenes[canvas].push_back(source.name);
+		// the transition table takes these over the first time a collection is loaded
+		if (!has_table && !source.transition.empty() && canvas == main_canvas)
+			add_rule(c, c.tables[main_canvas], "Any", source.name, {source.transition, source.duration});
+	}
+	if (!has_table && !sources.empty() && c.format.empty())
+		c.format = has_matrix ? "obs-transition-matrix" : "scene settings";
+	if (c.format.empty())
+		c.format = "empty";
+	return true;
+}
+
+static size_t rule_count(const transition_rules &rules)
+{
+	size_t count = 0;
+	for (const auto &from : rules)
+		count += from.second.size();
+	return count;
+}
+
+static const transition_rules *find_base(const collection &c, const string &canvas)
+{
+	auto options_it = c.options.find(canvas);
+	if (options_it == c.options.end() || options_it->second.shared_rules.empty())
+		return nullptr;
+	auto it = c.tables.find(options_it->second.shared_rules);
+	return it == c.tables.end() ? nullptr : &it->second;
+}
+
+static enum rule_precedence canvas_precedence(const collection &c, const string &canvas)
+{
+	auto it = c.options.find(canvas);
+	return it == c.options.end() ? RULE_PRECEDENCE_FROM_SCENE : it->second.precedence;
+}
+
+static const scene_group_table *find_groups(const collection &c, const string &canvas)
+{
+	auto it = c.groups.find(canvas);
+	return it == c.groups.end() ? nullptr : &it->second;
+}
+
+static void print_stats(const char *path, const collection &c)
+{
+	printf("%s: %s\n", path, c.format.c_str());
+	for (const auto &it : c.tables) {
+		size_t any = 0, groups = 0, patterns = 0;
+		for (const auto &from : it.second) {
+			for (const auto &to : from.second) {
+				if (from.first == "Any" || to.first == "Any")
+					any++;
+				if (is_scene_group(from.first) || is_scene_group(to.first))
+					groups++;
+				if (is_scene_pattern(from.first) || is_scene_pattern(to.first))
+					patterns++;
+			}
+		}
+		transition_decision_table dt;
+		dt.compile(it.second, find_base(c, it.first), find_groups(c, it.first), canvas_precedence(c, it.first));
+		const decision_table_memory memory = dt.memory();
+		printf("  %s: %zu rules, %zu from rows, %zu any, %zu group, %zu pattern, %zu bytes saved, %zu bytes in memory, %zu bytes compiled\n",
+		       it.first.c_str(), rule_count(it.second), it.second.size(), any, groups, patterns,
+		       transition_rules_save_size(it.second), transition_rules_memory(it.second),
+		       memory.rules + memory.index);
+	}
+	for (const auto &it : c.profiles) {
+		for (const auto &profile : it.second)
+			printf("  %s profile %s: %zu rules\n", it.first.c_str(), profile.first.c_str(), rule_count(profile.second));
+	}
+	for (const auto &it : c.groups)
+		printf("  %s: %zu groups, %zu grouped scenes\n", it.first.c_str(), it.second.groups.size(),
+		       it.second.scene_names.size());
+	for (const auto &it : c.scenes)
+		printf("  %s: %zu scenes\n", it.first.c_str(), it.second.size());
+	for (const auto &it : c.linked_files)
+		printf("  %s: linked to %s\n", it.first.c_str(), it.second.c_str());
+	if (c.duplicates)
+		printf("  %zu duplicate rules\n", c.duplicates);
+}
+
+static size_t print_issues(const char *path, const string &canvas, const char *profile, const vector<lint_issue> &issues)
+{
+	for (const auto &issue : issues)
+		printf("%s: %s%s%s: %s -> %s: %s %s\n", path, canvas.c_str(), profile ? " profile " : "", profile ? profile : "",
+		       issue.from_scene.c_str(), issue.to_scene.c_str(), lint_kind_name(issue.kind), issue.detail.c_str());
+	return issues.size();
+}
+
+// the number of issues found
+static size_t validate(const char *path, const collection &c)
+{
+	size_t count = 0;
+	if (c.duplicates) {
+		printf("%s: %zu duplicate rules\n", path, c.duplicates);
+		count += c.duplicates;
+	}
+	// Cut and Fade are not saved with the collection
+	vector<string> transitions = c.transitions;
+	if (!transitions.empty()) {
+		transitions.push_back("Cut");
+		transitions.push_back("Fade");
+	}
+	auto check = [&](const string &canvas, const char *profile, const transition_rules &rules) {
+		const transition_rules *base = find_base(c, canvas);
+		const scene_group_table *groups = find_groups(c, canvas);
+		const enum rule_precedence precedence = canvas_precedence(c, canvas);
+		auto scenes_it = c.scenes.find(canvas);
+		if (scenes_it != c.scenes.end() && !scenes_it->second.empty()) {
+			count += print_issues(path, canvas, profile,
+					      lint_transition_rules(rules, base, groups, precedence, scenes_it->second, transitions));
+			return;
+		}
+		// without the scenes only the patterns can be checked
+		transition_decision_table dt;
+		dt.compile(rules, base, groups, precedence);
+		for (const auto &error : dt.errors()) {
+			printf("%s: %s%s%s: %s\n", path, canvas.c_str(), profile ? " profile " : "", profile ? profile : "",
+			       error.c_str());
+			count++;
+		}
+	};
+	for (const auto &it : c.tables)
+		check(it.first, nullptr, it.second);
+	for (const auto &it : c.profiles) {
+		for (const auto &profile : it.second)
+			check(it.first, profile.first.c_str(), profile.second);
+	}
+	// rules for scenes of another canvas and pairs two canvases disagree on
+	if (c.scenes.size() > 1) {
+		map<string, transition_rules> tables;
+		for (const auto &it : c.tables) {
+			if (c.scenes.count(it.first))
+				tables.insert(it);
+		}
+		for (const auto &it : lint_cross_canvas(tables, c.scenes))
+			count += print_issues(path, it.first, nullptr, it.second);
+	}
+	return count;
+}
+
+static void write_json_string(FILE *file, const string &str)
+{
+	fputc('"', file);
+	for (const char ch : str) {
+		const unsigned char c = (unsigned char)ch;
+		if (c == '"' || c == '\\')
+			fprintf(file, "\\%c", c);
+		else if (c == '\n')
+			fputs("\\n", file);
+		else if (c == '\t')
+			fputs("\\t", file);
+		else if (c < 0x20)
+			fprintf(file, "\\u%04x", c);
+		else
+			fputc(c, file);
+	}
+	fputc('"', file);
+}
+
+// the format the dialog exports and imports, with the canvas of every rule
+static void write_export(FILE *file, const map<string, transition_rules> &tables)
+{
+	fputs("{\n    \"transitions\": [", file);
+	bool first = true;
+	for (const auto &table : tables) {
+		for (const auto &from : table.second) {
+			for (const auto &to : from.second) {
+				fputs(first ? "\n        {\"canvas\": " : ",\n        {\"canvas\": ", file);
+				first = false;
+				write_json_string(file, table.first);
+				fputs(", \"from_scene\": ", file);
+				write_json_string(file, from.first);
+				fputs(", \"to_scene\": ", file);
+				write_json_string(file, to.first);
+				fputs(", \"transition\": ", file);
+				write_json_string(file, to.second.transition);
+				fprintf(file, ", \"duration\": %d}", to.second.duration);
+			}
+		}
+	}
+	fputs(first ? "]\n}\n" : "\n    ]\n}\n", file);
+}
+
+// every name is stored once, the rules are [canvas, from scene, to scene, transition, duration] with indices
+static void write_compact(FILE *file, const map<string, transition_rules> &tables)
+{
+	vector<const string *> names;
+	map<string, size_t> name_ids;
+	auto intern = [&](const string &name) {
+		auto it = name_ids.emplace(name, names.size());
+		if (it.second)
+			names.push_back(&it.first->first);
+		return it.first->second;
+	};
+	vector<size_t> rules;
+	vector<int> durations;
+	for (const auto &table : tables) {
+		for (const auto &from : table.second) {
+			for (const auto &to : from.second) {
+				rules.push_back(intern(table.first));
+				rules.push_back(intern(from.first));
+				rules.push_back(intern(to.first));
+				rules.push_back(intern(to.second.transition));
+				durations.push_back(to.second.duration);
+			}
+		}
+	}
+	fputs("{\"format\":\"transition-table-compact\",\"version\":1,\"names\":[", file);
+	for (size_t i = 0; i < names.size(); i++) {
+		if (i)
+			fputc(',', file);
+		write_json_string(file, *names[i]);
+	}
+	fputs("],\"rules\":[", file);
+	for (size_t i = 0; i < durations.size(); i++)
+		fprintf(file, "%s[%zu,%zu,%zu,%zu,%d]", i ? "," : "", rules[i * 4], rules[i * 4 + 1], rules[i * 4 + 2],
+			rules[i * 4 + 3], durations[i]);
+	fputs("]}\n", file);
+}
+
+static string rule_text(const string &canvas, const string &from_scene, const string &to_scene, const transition_info &info)
+{
+	return canvas + ": " + from_scene + " -> " + to_scene + ": " + info.transition + " " + to_string(info.duration) + "ms";
+}
+
+// the number of rules that differ
+static size_t print_diff(const map<string, transition_rules> &a, const map<string, transition_rules> &b)
+{
+	static const transition_rules empty;
+	set<string> canvases;
+	for (const auto &it : a)
+		canvases.insert(it.first);
+	for (const auto &it : b)
+		canvases.insert(it.first);
+	size_t count = 0;
+	for (const auto &canvas : canvases) {
+		auto a_it = a.find(canvas);
+		auto b_it = b.find(canvas);
+		const transition_rules &ra = a_it == a.end() ? empty : a_it->second;
+		const transition_rules &rb = b_it == b.end() ? empty : b_it->second;
+		for (const auto &from : ra) {
+			auto b_from = rb.find(from.first);
+			for (const auto &to : from.second) {
+				const transition_info *other = nullptr;
+				if (b_from != rb.end()) {
+					auto b_to = b_from->second.find(to.first);
+					if (b_to != b_from->second.end())
+						other = &b_to->second;
+				}
+				if (!other) {
+					printf("- %s\n", rule_text(canvas, from.first, to.first, to.second).c_str());
+					count++;
+				} else if (*other != to.second) {
+					printf("~ %s -> %s %dms\n", rule_text(canvas, from.first, to.first, to.second).c_str(),
+					       other->transition.c_str(), other->duration);
+					count++;
+				}
+			}
+		}
+		for (const auto &from : rb) {
+			auto a_from = ra.find(from.first);
+			for (const auto &to : from.second) {
+				if (a_from != ra.end() && a_from->second.count(to.first))
+					continue;
+				printf("+ %s\n", rule_text(canvas, from.first, to.first, to.second).c_str());
+				count++;
+			}
+		}
+	}
+	return count;
+}
+
+enum merge_mode {
+	MERGE_MODE_REPLACE,
+	MERGE_MODE_MERGE,
+	MERGE_MODE_KEEP_EXISTING,
+};
+
+// like importing into the dialog, per canvas in the other tables
+static void merge_tables(map<string, transition_rules> &tables, const map<string, transition_rules> &other, enum merge_mode mode)
+{
+	for (const auto &it : other) {
+		auto &rules = tables[it.first];
+		if (mode == MERGE_MODE_REPLACE) {
+			rules = it.second;
+			continue;
+		}
+		for (const auto &from : it.second) {
+			for (const auto &to : from.second) {
+				if (mode == MERGE_MODE_MERGE)
+					rules[from.first][to.first] = to.second;
+				else
+					rules[from.first].emplace(to.first, to.second);
+			}
+		}
+	}
+}
+
+static int usage()
+{
+	fputs("usage: transition-table-cli [--main-canvas <name>] <command> ...\n"
+	      "  stats <file>...                     print statistics of the tables\n"
+	      "  validate <file>...                  check the rules against the scenes and transitions\n"
+	      "  convert [--compact] <file> [<out>]  write the tables as export or compact json\n"
+	      "  diff <file> <other>                 print the rules that were removed, changed or added\n"
+	      "  merge [--replace|--keep] <file> <other> [<out>]\n"
+	      "                                      merge the tables of other into file\n"
+	      "Files are scene collections, exported tables or compact tables, - reads stdin.\n",
+	      stderr);
+	return 2;
+}
+
+static bool load(const char *path, collection &c)
+{
+	string error;
+	if (read_collection(path, c, error))
+		return true;
+	fprintf(stderr, "%s: %s\n", path, error.c_str());
+	return false;
+}
+
+static FILE *open_output(const char *path)
+{
+	if (!path || strcmp(path, "-") == 0)
+		return stdout;
+	FILE *file = fopen(path, "wb");
+	if (!file)
+		fprintf(stderr, "%s: cannot write file\n", path);
+	return file;
+}
+
+static int write_tables(const char *path, const map<string, transition_rules> &tables, bool compact)
+{
+	FILE *file = open_output(path);
+	if (!file)
+		return 2;
+	if (compact)
+		write_compact(file, tables);
+	else
+		write_export(file, tables);
+	if (file != stdout)
+		fclose(file);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int arg = 1;
+	if (arg + 1 < argc && strcmp(argv[arg], "--main-canvas") == 0) {
+		main_canvas = argv[arg + 1];
+		arg += 2;
+	}
+	if (arg >= argc)
+		return usage();
+	const string command = argv[arg++];
+	vector<const char *> options;
+	vector<const char *> files;
+	for (; arg < argc; arg++) {
+		if (argv[arg][0] == '-' && argv[arg][1] == '-')
+			options.push_back(argv[arg]);
+		else
+			files.push_back(argv[arg]);
+	}
+	auto has_option = [&](const char *option) {
+		for (const char *o : options) {
+			if (strcmp(o, option) == 0)
+				return true;
+		}
+		return false;
+	};
+
+	if (command == "stats" || command == "validate") {
+		if (files.empty())
+			return usage();
+		int result = 0;
+		size_t issues = 0;
+		// one collection at a time, so any number of files fits in memory
+		for (const char *path : files) {
+			collection c;
+			if (!load(path, c)) {
+				result = 2;
+				continue;
+			}
+			if (command == "stats")
+				print_stats(path, c);
+			else
+				issues += validate(path, c);
+		}
+		if (command == "validate")
+			printf("%zu issues in %zu files\n", issues, files.size());
+		return result ? result : issues ? 1 : 0;
+	}
+	if (command == "convert") {
+		if (files.empty() || files.size() > 2)
+			return usage();
+		collection c;
+		if (!load(files[0], c))
+			return 2;
+		return write_tables(files.size() > 1 ? files[1] : nullptr, c.tables, has_option("--compact"));
+	}
+	if (command == "diff") {
+		if (files.size() != 2)
+			return usage();
+		collection a, b;
+		if (!load(files[0], a) || !load(files[1], b))
+			return 2;
+		return print_diff(a.tables, b.tables) ? 1 : 0;
+	}
+	if (command == "merge") {
+		if (files.size() < 2 || files.size() > 3)
+			return usage();
+		collection a, b;
+		if (!load(files[0], a) || !load(files[1], b))
+			return 2;
+		const enum merge_mode mode = has_option("--replace") ? MERGE_MODE_REPLACE
+					     : has_option("--keep")  ? MERGE_MODE_KEEP_EXISTING
+								     : MERGE_MODE_MERGE;
+		merge_tables(a.tables, b.tables, mode);
+		return write_tables(files.size() > 2 ? files[2] : nullptr, a.tables, has_option("--compact"));
+	}
+	return usage();
+}
@@ -0,0 +1,67 @@
+#include "transition-log.hpp"
+#include <cstdio>
+#include <mutex>
+#include <util/platform.h>
+
+using namespace std;
+
+atomic<bool> switch_log_active{false};
+static mutex switch_log_mutex;
+static FILE *switch_log_file = nullptr;
+static uint64_t switch_log_started = 0;
+static long long switch_log_entries = 0;
+
+// little endian so logs can be replayed on any machine
+static void write_uint(FILE *f, uint64_t value, size_t bytes)
+{
+	unsigned char buffer[8];
+	for (size_t i = 0; i < bytes; i++)
+		buffer[i] = (unsigned char)(value >> (8 * i));
+	fwrite(buffer, 1, bytes, f);
+}
+
+static void write_string(FILE *f, const string &s)
+{
+	write_uint(f, s.size(), 4);
+	fwrite(s.data(), 1, s.size(), f);
+}
+
+bool switch_log_start(const string &file)
+{
+	lock_guard<mutex> lock(switch_log_mutex);
+	if (switch_log_file)
+		return false;
+	switch_log_file = os_fopen(file.c_str(), "wb");
+	if (!switch_log_file)
+		return false;
+	fwrite(switch_log_magic, 1, sizeof(switch_log_magic), switch_log_file);
+	switch_log_started = os_gettime_ns();
+	switch_log_entries = 0;
+	switch_log_active.store(true, memory_order_relaxed);
+	return true;
+}
+
+long long switch_log_stop()
+{
+	lock_guard<mutex> lock(switch_log_mutex);
+	if (!switch_log_file)
+		return -1;
+	switch_log_active.store(false, memory_order_relaxed);
+	fclose(switch_log_file);
+	switch_log_file = nullptr;
+	return switch_log_entries;
+}
+
+void switch_log_write(enum switch_log_kind kind, const string &canvas, const string &a, const string &b)
+{
+	const uint64_t now = os_gettime_ns();
+	lock_guard<mutex> lock(switch_log_mutex);
+	if (!switch_log_file)
+		return;
+	write_uint(switch_log_file, kind, 1);
+	write_uint(switch_log_file, now - switch_log_started, 8);
+	write_string(switch_log_file, canvas);
+	write_string(switch_log_file, a);
+	write_string(switch_log_file, b);
+	switch_log_entries++;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compact binary log of what the plugin reacts to, so the switching of a show can be replayed with
+// tools/transition-log-replay. After the magic every entry is the kind, the nanoseconds since the log
+// started and three length prefixed strings, all little endian.
+static const char switch_log_magic[8] = {'T', 'T', 'S', 'W', 'L', 'O', 'G', 1};
+
+enum switch_log_kind : uint8_t {
+	// a is the rules snapshot of the canvas as json
+	SWITCH_LOG_RULES,
+	// a is the new program scene
+	SWITCH_LOG_CHANNEL_CHANGE,
+	SWITCH_LOG_TRANSITION_START,
+	// a is the new program scene of the main canvas
+	SWITCH_LOG_SCENE_CHANGED,
+	// a is the previous name, b the new name
+	SWITCH_LOG_RENAME,
+	// a is the scene the switch is prepared for
+	SWITCH_LOG_PREPARE_SWITCH,
+	// a is the request type, b the request data as json
+	SWITCH_LOG_REQUEST,
+	// a is the changed rules as json in the format of the undo data, b is "base" when they are the shared rules
+	// the canvas uses
+	SWITCH_LOG_RULE_CHANGES,
+};
+
+struct switch_log_entry {
+	enum switch_log_kind kind;
+	uint64_t time;
+	std::string canvas;
+	std::string a;
+	std::string b;
+};
+
+extern std::atomic<bool> switch_log_active;
+
+inline bool switch_log_recording()
+{
+	return switch_log_active.load(std::memory_order_relaxed);
+}
+
+bool switch_log_start(const std::string &file);
+// returns the number of entries written or -1 when nothing was recording
+long long switch_log_stop();
+void switch_log_write(enum switch_log_kind kind, const std::string &canvas, const std::string &a = std::string(),
+		      const std::string &b = std::string());
@@ -0,0 +1,747 @@
+#include "transition-rules.hpp"
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+using namespace std;
+
+size_t intern_group_scene(scene_group_table &sgt, const string &sceneName)
+{
+	auto it = sgt.scene_ids.find(sceneName);
+	if (it != sgt.scene_ids.end())
+		return it->second;
+	const size_t id = sgt.scene_names.size();
+	sgt.scene_names.push_back(sceneName);
+	sgt.scene_ids.emplace(sceneName, id);
+	return id;
+}
+
+bool scene_in_group(const vector<uint64_t> &members, size_t id)
+{
+	return id / 64 < members.size() && (members[id / 64] >> (id % 64)) & 1;
+}
+
+void rename_scene_in_rules(transition_rules &rules, const string &prev_name, const string &new_name)
+{
+	auto it = rules.find(prev_name);
+	if (it != rules.end()) {
+		rules[new_name] = it->second;
+		rules.erase(it);
+	}
+	for (auto &it2 : rules) {
+		auto it3 = it2.second.find(prev_name);
+		if (it3 != it2.second.end()) {
+			it2.second[new_name] = it3->second;
+			it2.second.erase(it3);
+		}
+	}
+}
+
+bool rename_scene_in_groups(scene_group_table &sgt, const string &prev_name, const string &new_name)
+{
+	auto id_it = sgt.scene_ids.find(prev_name);
+	if (id_it == sgt.scene_ids.end())
+		return false;
+	const size_t id = id_it->second;
+	sgt.scene_ids.erase(id_it);
+	auto new_it = sgt.scene_ids.find(new_name);
+	if (new_it == sgt.scene_ids.end()) {
+		sgt.scene_ids.emplace(new_name, id);
+		sgt.scene_names[id] = new_name;
+		return true;
+	}
+	// the new name is still interned for a scene that is gone, its id takes over the memberships
+	const size_t new_id = new_it->second;
+	for (auto &group : sgt.groups) {
+		auto &members = group.second;
+		const bool member = scene_in_group(members, id);
+		if (members.size() > id / 64)
+			members[id / 64] &= ~((uint64_t)1 << (id % 64));
+		if (members.size() > new_id / 64)
+			members[new_id / 64] &= ~((uint64_t)1 << (new_id % 64));
+		if (!member)
+			continue;
+		if (members.size() <= new_id / 64)
+			members.resize(new_id / 64 + 1);
+		members[new_id / 64] |= (uint64_t)1 << (new_id % 64);
+	}
+	return true;
+}
+
+bool is_scene_group(const string &key)
+{
+	return key.compare(0, 6, "group:") == 0;
+}
+
+bool is_scene_pattern(const string &key)
+{
+	return key.compare(0, 5, "glob:") == 0 || key.compare(0, 6, "regex:") == 0;
+}
+
+static string glob_to_regex(const string &glob)
+{
+	string result;
+	for (char c : glob) {
+		if (c == '*') {
+			result += ".*";
+		} else if (c == '?') {
+			result += '.';
+		} else {
+			if (c && strchr("\\^$.|+()[]{}", c))
+				result += '\\';
+			result += c;
+		}
+	}
+	return result;
+}
+
+uint32_t transition_decision_table::intern_key(const string &key)
+{
+	auto it = keys.find(key);
+	if (it != keys.end())
+		return it->second;
+	const uint32_t id = (uint32_t)keys.size();
+	keys.emplace(key, id);
+	key_names.push_back(key);
+	return id;
+}
+
+void transition_decision_table::compile(const transition_rules &rules, const transition_rules *base,
+					const scene_group_table *sgt, enum rule_precedence rule_precedence)
+{
+	precedence = rule_precedence;
+	keys.clear();
+	key_names.clear();
+	infos.clear();
+	info_keys.clear();
+	cells.clear();
+	group_scene_ids.clear();
+	groups.clear();
+	patterns.clear();
+	compile_errors.clear();
+	scene_ids.clear();
+	candidates.clear();
+	resolved.clear();
+
+	any_key = intern_key("Any");
+	for (const auto &from : rules) {
+		const uint32_t from_key = intern_key(from.first);
+		for (const auto &to : from.second) {
+			const uint32_t to_key = intern_key(to.first);
+			cells[(uint64_t)from_key << 32 | to_key] = (uint32_t)infos.size();
+			infos.push_back(to.second);
+			info_keys.emplace_back(from_key, to_key);
+		}
+	}
+	own_rules = infos.size();
+	if (base) {
+		for (const auto &from : *base) {
+			auto own_it = rules.find(from.first);
+			const uint32_t from_key = intern_key(from.first);
+			for (const auto &to : from.second) {
+				// the own rules override the base rules cell by cell
+				if (own_it != rules.end() && own_it->second.count(to.first))
+					continue;
+				const uint32_t to_key = intern_key(to.first);
+				cells[(uint64_t)from_key << 32 | to_key] = (uint32_t)infos.size();
+				infos.push_back(to.second);
+				info_keys.emplace_back(from_key, to_key);
+			}
+		}
+	}
+
+	if (sgt) {
+		group_scene_ids = sgt->scene_ids;
+		for (const auto &it : sgt->groups) {
+			// groups that no rule uses never change the result
+			auto key_it = keys.find(it.first);
+			if (key_it != keys.end())
+				groups.push_back({key_it->second, it.second});
+		}
+	}
+
+	vector<string> pattern_keys;
+	for (const auto &it : keys) {
+		if (is_scene_pattern(it.first))
+			pattern_keys.push_back(it.first);
+	}
+	// globs before regexes, both in name order
+	sort(pattern_keys.begin(), pattern_keys.end(), [](const string &a, const string &b) {
+		const bool a_glob = a[0] == 'g';
+		const bool b_glob = b[0] == 'g';
+		if (a_glob != b_glob)
+			return a_glob;
+		return a < b;
+	});
+	for (const auto &key : pattern_keys) {
+		try {
+			if (key[0] == 'g')
+				patterns.push_back({keys[key], regex(glob_to_regex(key.substr(5))), true});
+			else
+				patterns.push_back({keys[key], regex(key.substr(6)), false});
+		} catch (const regex_error &e) {
+			compile_errors.push_back("invalid pattern '" + key + "': " + e.what());
+		}
+	}
+}
+
+uint32_t transition_decision_table::get_scene_id(const string &sceneName)
+{
+	auto it = scene_ids.find(sceneName);
+	if (it != scene_ids.end())
+		return it->second;
+	vector<uint32_t> result;
+	auto key_it = keys.find(sceneName);
+	if (key_it != keys.end() && key_it->second != any_key)
+		result.push_back(key_it->second);
+	if (!groups.empty()) {
+		auto id_it = group_scene_ids.find(sceneName);
+		if (id_it != group_scene_ids.end()) {
+			for (const auto &g : groups) {
+				if (scene_in_group(g.members, id_it->second))
+					result.push_back(g.key);
+			}
+		}
+	}
+	if (!sceneName.empty()) {
+		for (const auto &p : patterns) {
+			if (p.full_match ? regex_match(sceneName, p.compiled) : regex_search(sceneName, p.compiled))
+				result.push_back(p.key);
+		}
+	}
+	result.push_back(any_key);
+	candidates.push_back(std::move(result));
+	return scene_ids.emplace(sceneName, (uint32_t)candidates.size() - 1).first->second;
+}
+
+int32_t transition_decision_table::find_cell(uint32_t from_key, uint32_t to_key) const
+{
+	auto it = cells.find((uint64_t)from_key << 32 | to_key);
+	return it == cells.end() ? -1 : (int32_t)it->second;
+}
+
+// a rule with an empty transition stops the lookup in its from row, less specific from rows still apply
+int32_t transition_decision_table::lookup(const string &from_scene, const string &to_scene, vector<bool> *used)
+{
+	const auto &from_keys = get_candidates(from_scene);
+	const auto &to_keys = get_candidates(to_scene);
+	if (precedence == RULE_PRECEDENCE_FROM_SCENE) {
+		for (auto from_key : from_keys) {
+			for (auto to_key : to_keys) {
+				const int32_t idx = find_cell(from_key, to_key);
+				if (idx < 0)
+					continue;
+				if (used)
+					(*used)[idx] = true;
+				if (!infos[idx].transition.empty())
+					return idx;
+				break;
+			}
+		}
+		return -1;
+	}
+	vector<bool> blocked(from_keys.size());
+	for (auto to_key : to_keys) {
+		for (size_t i = 0; i < from_keys.size(); i++) {
+			if (blocked[i])
+				continue;
+			const int32_t idx = find_cell(from_keys[i], to_key);
+			if (idx < 0)
+				continue;
+			if (used)
+				(*used)[idx] = true;
+			if (!infos[idx].transition.empty())
+				return idx;
+			blocked[i] = true;
+		}
+	}
+	return -1;
+}
+
+// the caches start over when they get this big, nothing holds on to them between resolves
+static const size_t max_cached_scenes = 1 << 14;
+static const size_t max_resolved_pairs = 1 << 16;
+
+int32_t transition_decision_table::resolve_rule(const string &from_scene, const string &to_scene)
+{
+	if (scene_ids.size() >= max_cached_scenes) {
+		scene_ids.clear();
+		candidates.clear();
+		resolved.clear();
+	} else if (resolved.size() >= max_resolved_pairs) {
+		resolved.clear();
+	}
+	const uint64_t pair = (uint64_t)get_scene_id(from_scene) << 32 | get_scene_id(to_scene);
+	auto it = resolved.find(pair);
+	return it != resolved.end() ? it->second : resolved.emplace(pair, lookup(from_scene, to_scene)).first->second;
+}
+
+const transition_info *transition_decision_table::resolve(const string &from_scene, const string &to_scene)
+{
+	const int32_t idx = resolve_rule(from_scene, to_scene);
+	return idx < 0 ? nullptr : &infos[idx];
+}
+
+// map nodes carry about four pointers besides the value, unordered map nodes a next pointer and the hash
+static const size_t map_node = 4 * sizeof(void *);
+static const size_t hash_node = 2 * sizeof(void *);
+
+size_t string_memory(const string &str)
+{
+	// strings only allocate past their inline buffer
+	static const size_t inline_capacity = string().capacity();
+	return str.capacity() > inline_capacity ? str.capacity() + 1 : 0;
+}
+
+template<class K, class V, class F> static size_t unordered_map_memory(const unordered_map<K, V> &m, F &&value_memory)
+{
+	size_t memory = m.bucket_count() * sizeof(void *);
+	for (const auto &it : m)
+		memory += hash_node + sizeof(it) + value_memory(it);
+	return memory;
+}
+
+decision_table_memory transition_decision_table::memory() const
+{
+	decision_table_memory memory;
+	memory.rules = infos.capacity() * sizeof(transition_info) + info_keys.capacity() * sizeof(info_keys[0]);
+	for (const auto &info : infos)
+		memory.rules += string_memory(info.transition);
+	memory.rules += unordered_map_memory(cells, [](const auto &) { return (size_t)0; });
+
+	memory.index = unordered_map_memory(keys, [](const auto &it) { return string_memory(it.first); });
+	memory.index += key_names.capacity() * sizeof(string);
+	for (const auto &name : key_names)
+		memory.index += string_memory(name);
+	for (const auto &it : group_scene_ids)
+		memory.index += map_node + sizeof(it) + string_memory(it.first);
+	memory.index += groups.capacity() * sizeof(group) + patterns.capacity() * sizeof(pattern);
+	for (const auto &g : groups)
+		memory.index += g.members.capacity() * sizeof(uint64_t);
+
+	memory.caches = unordered_map_memory(scene_ids, [](const auto &it) { return string_memory(it.first); });
+	for (const auto &c : candidates)
+		memory.caches += sizeof(c) + c.capacity() * sizeof(uint32_t);
+	memory.caches += unordered_map_memory(resolved, [](const auto &) { return (size_t)0; });
+	memory.cached_pairs = resolved.size();
+	return memory;
+}
+
+size_t scene_group_table_memory(const scene_group_table &sgt)
+{
+	size_t memory = sgt.scene_names.capacity() * sizeof(string);
+	for (const auto &name : sgt.scene_names)
+		memory += string_memory(name);
+	for (const auto &it : sgt.scene_ids)
+		memory += map_node + sizeof(it) + string_memory(it.first);
+	for (const auto &it : sgt.groups)
+		memory += map_node + sizeof(it) + string_memory(it.first) + it.second.capacity() * sizeof(uint64_t);
+	return memory;
+}
+
+size_t transition_rules_memory(const transition_rules &rules)
+{
+	size_t memory = 0;
+	for (const auto &from : rules) {
+		memory += map_node + sizeof(from) + string_memory(from.first);
+		for (const auto &to : from.second)
+			memory += map_node + sizeof(to) + string_memory(to.first) + string_memory(to.second.transition);
+	}
+	return memory;
+}
+
+size_t transition_rules_save_size(const transition_rules &rules)
+{
+	// {"from_scene": "", "to_scene": "", "transition": "", "duration": }, as written by obs_data
+	const size_t overhead = 66;
+	size_t size = 0;
+	for (const auto &from : rules) {
+		for (const auto &to : from.second)
+			size += overhead + from.first.size() + to.first.size() + to.second.transition.size() +
+				to_string(to.second.duration).size();
+	}
+	return size;
+}
+
+static size_t count_rules(const transition_rules &rules)
+{
+	size_t count = 0;
+	for (const auto &from : rules)
+		count += from.second.size();
+	return count;
+}
+
+static bool same_info(const transition_info *a, const transition_info *b)
+{
+	if (!a || !b)
+		return a == b;
+	return *a == *b;
+}
+
+transition_rules minimize_transition_rules(const transition_rules &rules, const transition_rules *base,
+					   const scene_group_table *groups, enum rule_precedence precedence,
+					   const vector<string> &scenes, minimize_result &result,
+					   const function<void(size_t done, size_t count)> &progress)
+{
+	result = minimize_result();
+	result.rules_before = count_rules(rules);
+	result.memory_before = transition_rules_memory(rules);
+	result.save_size_before = transition_rules_save_size(rules);
+	const size_t n = scenes.size();
+
+	// every pair of scenes resolved without the resolved cache, nullptr where no rule applies
+	// OBS never transitions from a scene to itself, those pairs are left out and stay nullptr
+	auto resolve_all = [&scenes, n](transition_decision_table &t) {
+		vector<const transition_info *> resolved(n * n, nullptr);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				if (i == j)
+					continue;
+				const int32_t idx = t.lookup(scenes[i], scenes[j]);
+				resolved[i * n + j] = idx < 0 ? nullptr : &t.infos[idx];
+			}
+		}
+		return resolved;
+	};
+
+	transition_decision_table original;
+	original.compile(rules, base, groups, precedence);
+	const auto expected = resolve_all(original);
+
+	// a to scene that has the same transition from most other scenes gets an Any rule
+	// Each fold is compiled and checked on its own, a fold that changes how its to scene resolves is dropped
+	// without costing the other folds. An Any rule for a to scene only decides pairs with that to scene.
+	transition_rules folded_rules = rules;
+	transition_rules trial = rules;
+	transition_decision_table dt;
+	size_t folded = 0;
+	for (size_t j = 0; j < n; j++) {
+		map<pair<string, int>, size_t> counts;
+		bool all = true;
+		for (size_t i = 0; i < n && all; i++) {
+			if (i == j)
+				continue;
+			auto from_it = rules.find(scenes[i]);
+			const transition_info *info = nullptr;
+			if (from_it != rules.end()) {
+				auto to_it = from_it->second.find(scenes[j]);
+				if (to_it != from_it->second.end())
+					info = &to_it->second;
+			}
+			// only safe when no from scene falls through to the Any row
+			if (!info || info->transition.empty())
+				all = false;
+			else
+				counts[{info->transition, info->duration}]++;
+		}
+		if (!all || counts.empty())
+			continue;
+		auto best = max_element(counts.begin(), counts.end(),
+					[](const auto &a, const auto &b) { return a.second < b.second; });
+		if (best->second < 2)
+			continue;
+		const transition_info fold = {best->first.first, best->first.second};
+		const transition_info *previous = nullptr;
+		auto any_it = rules.find("Any");
+		if (any_it != rules.end()) {
+			auto to_it = any_it->second.find(scenes[j]);
+			if (to_it != any_it->second.end())
+				previous = &to_it->second;
+		}
+		if (previous && *previous == fold)
+			continue;
+		trial["Any"][scenes[j]] = fold;
+		dt.compile(trial, base, groups, precedence);
+		bool same = true;
+		for (size_t i = 0; i < n && same; i++) {
+			if (i == j)
+				continue;
+			const int32_t r = dt.lookup(scenes[i], scenes[j]);
+			same = same_info(r < 0 ? nullptr : &dt.infos[r], expected[i * n + j]);
+		}
+		if (previous) {
+			trial["Any"][scenes[j]] = *previous;
+		} else {
+			trial["Any"].erase(scenes[j]);
+			if (trial["Any"].empty())
+				trial.erase("Any");
+		}
+		if (!same)
+			continue;
+		folded_rules["Any"][scenes[j]] = fold;
+		folded++;
+	}
+	dt.compile(folded_rules, base, groups, precedence);
+	result.folded = folded;
+
+	// scenes each key applies to
+	unordered_map<uint32_t, vector<size_t>> key_scenes;
+	for (size_t i = 0; i < n; i++) {
+		for (auto key : dt.get_candidates(scenes[i]))
+			key_scenes[key].push_back(i);
+	}
+
+	// specific rules go before the Any row so the rules folded into Any are the ones removed
+	vector<const transition_rules::value_type *> rows;
+	for (const auto &from : folded_rules) {
+		if (from.first != "Any")
+			rows.push_back(&from);
+	}
+	auto any_it = folded_rules.find("Any");
+	if (any_it != folded_rules.end())
+		rows.push_back(&*any_it);
+
+	transition_rules minimized = folded_rules;
+	for (size_t row_idx = 0; row_idx < rows.size(); row_idx++) {
+		if (progress)
+			progress(row_idx, rows.size());
+		const auto &from = *rows[row_idx];
+		const uint32_t from_key = dt.keys[from.first];
+		auto from_scenes_it = key_scenes.find(from_key);
+		const transition_rules::mapped_type *base_row = nullptr;
+		if (base) {
+			auto base_it = base->find(from.first);
+			if (base_it != base->end())
+				base_row = &base_it->second;
+		}
+		for (const auto &to : from.second) {
+			const uint32_t to_key = dt.keys[to.first];
+			auto to_scenes_it = key_scenes.find(to_key);
+			// rules for scenes that do not exist are left alone
+			if (from_scenes_it == key_scenes.end() || to_scenes_it == key_scenes.end())
+				continue;
+			const uint64_t cell_key = (uint64_t)from_key << 32 | to_key;
+			const uint32_t idx = dt.cells[cell_key];
+			// without the own rule the base rule for the pair applies again
+			const transition_info *base_info = nullptr;
+			if (base_row) {
+				auto base_it = base_row->find(to.first);
+				if (base_it != base_row->end())
+					base_info = &base_it->second;
+			}
+			if (base_info) {
+				dt.cells[cell_key] = (uint32_t)dt.infos.size();
+				dt.infos.push_back(*base_info);
+			} else {
+				dt.cells.erase(cell_key);
+			}
+			bool same = true;
+			for (size_t i : from_scenes_it->second) {
+				for (size_t j : to_scenes_it->second) {
+					if (i == j)
+						continue;
+					const int32_t r = dt.lookup(scenes[i], scenes[j]);
+					same = same_info(r < 0 ? nullptr : &dt.infos[r], expected[i * n + j]);
+					if (!same)
+						break;
+				}
+				if (!same)
+					break;
+			}
+			if (!same) {
+				dt.cells[cell_key] = idx;
+				continue;
+			}
+			auto &row = minimized[from.first];
+			row.erase(to.first);
+			if (row.empty())
+				minimized.erase(from.first);
+			result.removed++;
+		}
+	}
+
+	result.rules_after = count_rules(minimized);
+	result.memory_after = transition_rules_memory(minimized);
+	result.save_size_after = transition_rules_save_size(minimized);
+	return minimized;
+}
+
+const char *lint_kind_name(enum lint_kind kind)
+{
+	switch (kind) {
+	case LINT_MISSING_SCENE:
+		return "missing_scene";
+	case LINT_MISSING_GROUP:
+		return "missing_group";
+	case LINT_MISSING_TRANSITION:
+		return "missing_transition";
+	case LINT_INVALID_PATTERN:
+		return "invalid_pattern";
+	case LINT_UNREACHABLE:
+		return "unreachable";
+	case LINT_SHADOWED:
+		return "shadowed";
+	case LINT_CROSS_CANVAS_SCENE:
+		return "cross_canvas_scene";
+	case LINT_CROSS_CANVAS_CONFLICT:
+		return "cross_canvas_conflict";
+	}
+	return "";
+}
+
+vector<lint_issue> lint_transition_rules(const transition_rules &rules, const transition_rules *base,
+					 const scene_group_table *groups, enum rule_precedence precedence,
+					 const vector<string> &scenes, const vector<string> &transitions)
+{
+	vector<lint_issue> issues;
+	transition_decision_table dt;
+	dt.compile(rules, base, groups, precedence);
+
+	// the cells in compile order, own rules first
+	vector<pair<const string *, const string *>> cell_names;
+	for (const auto &from : rules) {
+		for (const auto &to : from.second)
+			cell_names.emplace_back(&from.first, &to.first);
+	}
+	const size_t own_count = cell_names.size();
+	if (base) {
+		for (const auto &from : *base) {
+			auto own_it = rules.find(from.first);
+			for (const auto &to : from.second) {
+				if (own_it == rules.end() || !own_it->second.count(to.first))
+					cell_names.emplace_back(&from.first, &to.first);
+			}
+		}
+	}
+
+	unordered_map<uint32_t, size_t> key_scene_count;
+	for (const auto &scene : scenes) {
+		for (auto key : dt.get_candidates(scene))
+			key_scene_count[key]++;
+	}
+	set<uint32_t> valid_patterns;
+	for (const auto &p : dt.patterns)
+		valid_patterns.insert(p.key);
+	const set<string> scene_set(scenes.begin(), scenes.end());
+	const set<string> transition_set(transitions.begin(), transitions.end());
+
+	// which cells ever decide for a pair of scenes, and which decides a pair first
+	vector<bool> used(dt.infos.size());
+	map<pair<uint32_t, uint32_t>, int32_t> first_decider;
+	for (const auto &from : scenes) {
+		for (const auto &to : scenes) {
+			const int32_t idx = dt.lookup(from, to, &used);
+			if (idx < 0)
+				continue;
+			for (auto from_key : dt.get_candidates(from)) {
+				for (auto to_key : dt.get_candidates(to))
+					first_decider.emplace(make_pair(from_key, to_key), idx);
+			}
+		}
+	}
+
+	// a key that can never match, reported once per rule
+	auto check_key = [&](const string &key, uint32_t id, lint_issue issue) {
+		if (key == "Any")
+			return true;
+		if (is_scene_group(key)) {
+			if (!groups || !groups->groups.count(key)) {
+				issue.kind = LINT_MISSING_GROUP;
+				issue.detail = key;
+				issues.push_back(issue);
+				return false;
+			}
+		} else if (is_scene_pattern(key)) {
+			if (!valid_patterns.count(id)) {
+				issue.kind = LINT_INVALID_PATTERN;
+				issue.detail = key;
+				issues.push_back(issue);
+				return false;
+			}
+		} else if (!scene_set.count(key)) {
+			issue.kind = LINT_MISSING_SCENE;
+			issue.detail = key;
+			issues.push_back(issue);
+			return false;
+		}
+		if (!key_scene_count.count(id)) {
+			issue.kind = LINT_UNREACHABLE;
+			issue.detail = key;
+			issues.push_back(issue);
+			return false;
+		}
+		return true;
+	};
+
+	for (size_t k = 0; k < own_count; k++) {
+		const string &from = *cell_names[k].first;
+		const string &to = *cell_names[k].second;
+		const transition_info &info = rules.at(from).at(to);
+		lint_issue issue{LINT_MISSING_SCENE, from, to, string()};
+		if (!info.transition.empty() && !transition_set.empty() && !transition_set.count(info.transition)) {
+			issue.kind = LINT_MISSING_TRANSITION;
+			issue.detail = info.transition;
+			issues.push_back(issue);
+		}
+		const uint32_t from_key = dt.keys[from];
+		const uint32_t to_key = dt.keys[to];
+		const bool from_ok = check_key(from, from_key, issue);
+		const bool to_ok = check_key(to, to_key, issue);
+		if (!from_ok || !to_ok || used[k])
+			continue;
+		issue.kind = LINT_SHADOWED;
+		auto decider = first_decider.find({from_key, to_key});
+		if (decider != first_decider.end() && (size_t)decider->second < cell_names.size())
+			issue.detail = *cell_names[decider->second].first + " -> " + *cell_names[decider->second].second;
+		issues.push_back(issue);
+	}
+	return issues;
+}
+
+static bool is_scene_key(const string &key)
+{
+	return key != "Any" && !is_scene_group(key) && !is_scene_pattern(key);
+}
+
+vector<lint_issue> lint_cross_canvas_pair(const transition_rules &rules, const set<string> &scenes, const string &other,
+					  const transition_rules &other_rules, const set<string> &other_scenes)
+{
+	vector<lint_issue> issues;
+	for (const auto &from : rules) {
+		for (const auto &to : from.second) {
+			const bool from_scene = is_scene_key(from.first);
+			const bool to_scene = is_scene_key(to.first);
+			const bool from_here = !from_scene || scenes.count(from.first);
+			const bool to_here = !to_scene || scenes.count(to.first);
+			if (!from_here || !to_here) {
+				// the rule was probably meant for the other canvas
+				if ((from_here || other_scenes.count(from.first)) && (to_here || other_scenes.count(to.first)))
+					issues.push_back({LINT_CROSS_CANVAS_SCENE, from.first, to.first, other});
+				continue;
+			}
+			if (!from_scene || !to_scene || !other_scenes.count(from.first) || !other_scenes.count(to.first))
+				continue;
+			auto other_from = other_rules.find(from.first);
+			if (other_from == other_rules.end())
+				continue;
+			auto other_to = other_from->second.find(to.first);
+			if (other_to != other_from->second.end() && other_to->second != to.second)
+				issues.push_back({LINT_CROSS_CANVAS_CONFLICT, from.first, to.first, other});
+		}
+	}
+	return issues;
+}
+
+map<string, vector<lint_issue>> lint_cross_canvas(const map<string, transition_rules> &tables,
+						  const map<string, vector<string>> &canvas_scenes)
+{
+	map<string, vector<lint_issue>> issues;
+	map<string, set<string>> scene_sets;
+	for (const auto &it : tables)
+		scene_sets[it.first];
+	for (const auto &it : canvas_scenes)
+		scene_sets[it.first].insert(it.second.begin(), it.second.end());
+
+	for (const auto &table : tables) {
+		for (const auto &other : tables) {
+			if (other.first == table.first)
+				continue;
+			auto pair_issues = lint_cross_canvas_pair(table.second, scene_sets[table.first], other.first,
+								  other.second, scene_sets[other.first]);
+			if (!pair_issues.empty())
+				issues[table.first].insert(issues[table.first].end(), pair_issues.begin(),
+							   pair_issues.end());
+		}
+	}
+	return issues;
+}
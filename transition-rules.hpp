@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <regex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct transition_info {
+	std::string transition;
+	int duration;
+
+	bool operator==(const transition_info &other) const
+	{
+		return transition == other.transition && duration == other.duration;
+	}
+	bool operator!=(const transition_info &other) const { return !(*this == other); }
+};
+
+// from scene -> to scene -> transition
+// besides scene names the keys can be "Any", "group:<name>", "glob:<pattern>" or "regex:<expression>"
+typedef std::map<std::string, std::map<std::string, transition_info>> transition_rules;
+
+struct scene_group_table {
+	// interned scene names, the ids index the membership bitsets
+	std::map<std::string, size_t> scene_ids;
+	std::vector<std::string> scene_names;
+	// "group:<name>" -> membership bitset
+	std::map<std::string, std::vector<uint64_t>> groups;
+};
+
+size_t intern_group_scene(scene_group_table &sgt, const std::string &sceneName);
+bool scene_in_group(const std::vector<uint64_t> &members, size_t id);
+bool is_scene_group(const std::string &key);
+bool is_scene_pattern(const std::string &key);
+// both keep the rules and memberships of the scene under the new name
+void rename_scene_in_rules(transition_rules &rules, const std::string &prev_name, const std::string &new_name);
+// false when the table never interned the scene
+bool rename_scene_in_groups(scene_group_table &sgt, const std::string &prev_name, const std::string &new_name);
+
+enum rule_precedence {
+	// a more specific from scene wins, Cam 1 -> Any beats Any -> Cam 2
+	RULE_PRECEDENCE_FROM_SCENE,
+	// a more specific to scene wins, Any -> Cam 2 beats Cam 1 -> Any
+	RULE_PRECEDENCE_TO_SCENE,
+};
+
+struct minimize_result {
+	size_t rules_before = 0;
+	size_t rules_after = 0;
+	// rules that never changed how a pair of scenes resolves
+	size_t removed = 0;
+	// Any rules added for to scenes that all other scenes shared
+	size_t folded = 0;
+	// estimates of the memory and save file size of the rules
+	size_t memory_before = 0;
+	size_t memory_after = 0;
+	size_t save_size_before = 0;
+	size_t save_size_after = 0;
+};
+
+enum lint_kind {
+	// detail is the scene that does not exist
+	LINT_MISSING_SCENE,
+	// detail is the group that does not exist
+	LINT_MISSING_GROUP,
+	// detail is the transition that does not exist
+	LINT_MISSING_TRANSITION,
+	// detail is the pattern that does not compile
+	LINT_INVALID_PATTERN,
+	// the group or pattern matches no scene
+	LINT_UNREACHABLE,
+	// detail is the rule that decides instead, as "from -> to"
+	LINT_SHADOWED,
+	// detail is the other canvas
+	LINT_CROSS_CANVAS_SCENE,
+	LINT_CROSS_CANVAS_CONFLICT,
+};
+
+struct lint_issue {
+	enum lint_kind kind;
+	std::string from_scene;
+	std::string to_scene;
+	std::string detail;
+};
+
+const char *lint_kind_name(enum lint_kind kind);
+
+// heap memory estimates, the size of the object itself is not included
+size_t string_memory(const std::string &str);
+size_t transition_rules_memory(const transition_rules &rules);
+size_t scene_group_table_memory(const scene_group_table &sgt);
+
+struct decision_table_memory {
+	// infos and cells
+	size_t rules = 0;
+	// interned keys, groups and patterns, compiled regexes are not included
+	size_t index = 0;
+	// candidates and resolved pairs
+	size_t caches = 0;
+	size_t cached_pairs = 0;
+};
+size_t transition_rules_save_size(const transition_rules &rules);
+
+// The rules of one canvas compiled into a flat table. Every key is interned, rules are found by the
+// pair of key ids and the candidate keys of a scene (exact, groups, patterns, Any) are computed once
+// per scene name. Resolved from/to pairs are cached until the table is compiled again.
+// The rules can be layered on base rules, a rule for the same from/to pair replaces the base rule.
+// Every resolve, also resolve_uncached, can add to the caches, so a table is only used by one thread at a time.
+class transition_decision_table {
+public:
+	void compile(const transition_rules &rules, const transition_rules *base, const scene_group_table *groups,
+		     enum rule_precedence precedence);
+	const transition_info *resolve(const std::string &from_scene, const std::string &to_scene);
+	// without adding the pair to the resolve cache, for scans over every pair
+	const transition_info *resolve_uncached(const std::string &from_scene, const std::string &to_scene)
+	{
+		const int32_t idx = lookup(from_scene, to_scene);
+		return idx < 0 ? nullptr : &infos[idx];
+	}
+	// the id of the rule that decides or -1, ids are only valid until the table is compiled again
+	int32_t resolve_rule(const std::string &from_scene, const std::string &to_scene);
+	const transition_info &rule_info(int32_t rule) const { return infos[rule]; }
+	const std::string &rule_from_key(int32_t rule) const { return key_names[info_keys[rule].first]; }
+	const std::string &rule_to_key(int32_t rule) const { return key_names[info_keys[rule].second]; }
+	// the rule comes from the base rules
+	bool rule_is_base(int32_t rule) const { return (size_t)rule >= own_rules; }
+
+	size_t rule_count() const { return infos.size(); }
+	decision_table_memory memory() const;
+	const std::vector<std::string> &errors() const { return compile_errors; }
+
+	friend std::vector<lint_issue> lint_transition_rules(const transition_rules &rules, const transition_rules *base,
+							     const scene_group_table *groups, enum rule_precedence precedence,
+							     const std::vector<std::string> &scenes,
+							     const std::vector<std::string> &transitions);
+	friend transition_rules minimize_transition_rules(const transition_rules &rules, const transition_rules *base,
+							  const scene_group_table *groups, enum rule_precedence precedence,
+							  const std::vector<std::string> &scenes, minimize_result &result,
+							  const std::function<void(size_t done, size_t count)> &progress);
+
+private:
+	struct group {
+		uint32_t key;
+		std::vector<uint64_t> members;
+	};
+	struct pattern {
+		uint32_t key;
+		std::regex compiled;
+		bool full_match;
+	};
+
+	enum rule_precedence precedence = RULE_PRECEDENCE_FROM_SCENE;
+	std::unordered_map<std::string, uint32_t> keys;
+	std::vector<std::string> key_names;
+	std::vector<transition_info> infos;
+	// (from key, to key) of every info, the own rules come first
+	std::vector<std::pair<uint32_t, uint32_t>> info_keys;
+	size_t own_rules = 0;
+	// (from key << 32 | to key) -> index in infos
+	std::unordered_map<uint64_t, uint32_t> cells;
+	std::map<std::string, size_t> group_scene_ids;
+	std::vector<group> groups;
+	std::vector<pattern> patterns;
+	uint32_t any_key = UINT32_MAX;
+	std::vector<std::string> compile_errors;
+
+	// scene name -> scene id, the candidates of a scene are the keys that apply to it, most specific first.
+	// A deque so the candidates of one scene stay valid while another scene is added.
+	std::unordered_map<std::string, uint32_t> scene_ids;
+	std::deque<std::vector<uint32_t>> candidates;
+	// (from scene id << 32 | to scene id) -> index in infos or -1
+	std::unordered_map<uint64_t, int32_t> resolved;
+
+	uint32_t intern_key(const std::string &key);
+	uint32_t get_scene_id(const std::string &sceneName);
+	const std::vector<uint32_t> &get_candidates(const std::string &sceneName)
+	{
+		return candidates[get_scene_id(sceneName)];
+	}
+	int32_t find_cell(uint32_t from_key, uint32_t to_key) const;
+	// marks the cells that decided, also the empty ones that stopped their from row
+	int32_t lookup(const std::string &from_scene, const std::string &to_scene, std::vector<bool> *used = nullptr);
+};
+
+// Returns the rules without the rules that do not change how any pair of two different given scenes resolves.
+// Rules for scenes that are not in the list are kept, to scene columns that every other scene has
+// are folded into an Any rule first when that gives the same resolution.
+// progress is called with the from rows checked so far, from the calling thread.
+transition_rules minimize_transition_rules(const transition_rules &rules, const transition_rules *base,
+					   const scene_group_table *groups, enum rule_precedence precedence,
+					   const std::vector<std::string> &scenes, minimize_result &result,
+					   const std::function<void(size_t done, size_t count)> &progress = nullptr);
+
+// Checks the own rules of one canvas against its scenes and transitions. Only the own rules are
+// reported, the base rules are used to find what decides instead.
+std::vector<lint_issue> lint_transition_rules(const transition_rules &rules, const transition_rules *base,
+					      const scene_group_table *groups, enum rule_precedence precedence,
+					      const std::vector<std::string> &scenes, const std::vector<std::string> &transitions);
+
+// The issues of the rules of one canvas against one other canvas, what lint_cross_canvas reports for
+// that pair. Lets callers only recheck the pairs of canvases that changed.
+std::vector<lint_issue> lint_cross_canvas_pair(const transition_rules &rules, const std::set<std::string> &scenes,
+					       const std::string &other, const transition_rules &other_rules,
+					       const std::set<std::string> &other_scenes);
+
+// canvas -> issues, for rules whose scenes only exist on another canvas and for scene pairs both
+// canvases have that get a different transition
+std::map<std::string, std::vector<lint_issue>>
+lint_cross_canvas(const std::map<std::string, transition_rules> &tables,
+		  const std::map<std::string, std::vector<std::string>> &canvas_scenes);
@@ -0,0 +1,228 @@
+#include "transition-stats.hpp"
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+transition_stats stats;
+
+void latency_histogram::record(uint64_t ns)
+{
+	size_t bucket = 0;
+	while (bucket + 1 < bucket_count && ns >> (bucket + 1))
+		bucket++;
+	buckets[bucket].fetch_add(1, memory_order_relaxed);
+	counted.fetch_add(1, memory_order_relaxed);
+	total.fetch_add(ns, memory_order_relaxed);
+	uint64_t current = maximum.load(memory_order_relaxed);
+	while (ns > current && !maximum.compare_exchange_weak(current, ns, memory_order_relaxed))
+		;
+}
+
+void latency_histogram::reset()
+{
+	for (auto &bucket : buckets)
+		bucket.store(0, memory_order_relaxed);
+	counted.store(0, memory_order_relaxed);
+	total.store(0, memory_order_relaxed);
+	maximum.store(0, memory_order_relaxed);
+}
+
+uint64_t latency_histogram::percentile_ns(double percentile) const
+{
+	const uint64_t n = count();
+	if (!n)
+		return 0;
+	const uint64_t target = (uint64_t)(percentile * (double)n / 100.0);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < bucket_count; i++) {
+		seen += buckets[i].load(memory_order_relaxed);
+		if (seen > target)
+			return min(max_ns(), ((uint64_t)2 << i) - 1);
+	}
+	return max_ns();
+}
+
+static const struct {
+	const char *name;
+	latency_histogram transition_stats::*histogram;
+} histograms[] = {
+	{"resolve", &transition_stats::resolve},
+	{"override_pass", &transition_stats::override_pass},
+	{"queue_wait", &transition_stats::queue_wait},
+	{"save", &transition_stats::save},
+	{"load", &transition_stats::load},
+	{"refresh_table", &transition_stats::refresh_table},
+};
+
+void reset_stats()
+{
+	for (const auto &h : histograms)
+		(stats.*h.histogram).reset();
+	stats.scenes_scanned.store(0, memory_order_relaxed);
+	stats.overrides_written.store(0, memory_order_relaxed);
+}
+
+void histogram_to_data(const latency_histogram &histogram, obs_data_t *obj)
+{
+	const uint64_t count = histogram.count();
+	obs_data_set_int(obj, "count", (long long)count);
+	obs_data_set_double(obj, "avg_us", count ? (double)histogram.total_ns() / (double)count / 1000.0 : 0.0);
+	obs_data_set_double(obj, "p50_us", (double)histogram.percentile_ns(50.0) / 1000.0);
+	obs_data_set_double(obj, "p90_us", (double)histogram.percentile_ns(90.0) / 1000.0);
+	obs_data_set_double(obj, "p99_us", (double)histogram.percentile_ns(99.0) / 1000.0);
+	obs_data_set_double(obj, "max_us", (double)histogram.max_ns() / 1000.0);
+}
+
+void stats_to_data(obs_data_t *data)
+{
+	for (const auto &h : histograms) {
+		obs_data_t *obj = obs_data_create();
+		histogram_to_data(stats.*h.histogram, obj);
+		obs_data_set_obj(data, h.name, obj);
+		obs_data_release(obj);
+	}
+	obs_data_set_int(data, "scenes_scanned", (long long)stats.scenes_scanned.load(memory_order_relaxed));
+	obs_data_set_int(data, "overrides_written", (long long)stats.overrides_written.load(memory_order_relaxed));
+}
+
+string stats_summary()
+{
+	string summary;
+	char buffer[256];
+	for (const auto &h : histograms) {
+		const latency_histogram &histogram = stats.*h.histogram;
+		const uint64_t count = histogram.count();
+		if (!count)
+			continue;
+		snprintf(buffer, sizeof(buffer), "%s%s: %llu, avg %.1fus, p99 %.1fus, max %.1fus", summary.empty() ? "" : "; ",
+			 h.name, (unsigned long long)count, (double)histogram.total_ns() / (double)count / 1000.0,
+			 (double)histogram.percentile_ns(99.0) / 1000.0, (double)histogram.max_ns() / 1000.0);
+		summary += buffer;
+	}
+	snprintf(buffer, sizeof(buffer), "%sscenes scanned: %llu, overrides written: %llu", summary.empty() ? "" : "; ",
+		 (unsigned long long)stats.scenes_scanned.load(memory_order_relaxed),
+		 (unsigned long long)stats.overrides_written.load(memory_order_relaxed));
+	summary += buffer;
+	return summary;
+}
+
+struct trace_event {
+	const char *name;
+	string canvas;
+	thread::id thread_id;
+	const char *thread_name;
+	uint64_t start;
+	uint64_t end;
+};
+
+// keeps a forgotten trace from growing without limit
+static const size_t max_trace_events = 1000000;
+
+atomic<bool> trace_active{false};
+static mutex trace_mutex;
+static vector<trace_event> trace_events;
+static string trace_file;
+
+bool start_trace(const string &file)
+{
+	lock_guard<mutex> lock(trace_mutex);
+	if (trace_active.load(memory_order_relaxed))
+		return false;
+	trace_events.clear();
+	trace_file = file;
+	trace_active.store(true, memory_order_relaxed);
+	return true;
+}
+
+static const char *current_thread_name()
+{
+	if (obs_in_task_thread(OBS_TASK_UI))
+		return "ui";
+	if (obs_in_task_thread(OBS_TASK_GRAPHICS))
+		return "graphics";
+	if (obs_in_task_thread(OBS_TASK_AUDIO))
+		return "audio";
+	return nullptr;
+}
+
+void record_trace_event(const char *name, const char *canvas, uint64_t start, uint64_t end)
+{
+	trace_event event{name, canvas ? canvas : "", this_thread::get_id(), current_thread_name(), start, end};
+	lock_guard<mutex> lock(trace_mutex);
+	if (!trace_active.load(memory_order_relaxed) || trace_events.size() >= max_trace_events)
+		return;
+	trace_events.push_back(std::move(event));
+}
+
+static void add_trace_metadata(obs_data_array_t *array, const char *kind, long long pid, long long tid, const char *name)
+{
+	obs_data_t *event = obs_data_create();
+	obs_data_set_string(event, "name", kind);
+	obs_data_set_string(event, "ph", "M");
+	obs_data_set_int(event, "pid", pid);
+	obs_data_set_int(event, "tid", tid);
+	obs_data_t *args = obs_data_create();
+	obs_data_set_string(args, "name", name);
+	obs_data_set_obj(event, "args", args);
+	obs_data_release(args);
+	obs_data_array_push_back(array, event);
+	obs_data_release(event);
+}
+
+long long stop_trace(string &file)
+{
+	vector<trace_event> events;
+	{
+		lock_guard<mutex> lock(trace_mutex);
+		if (!trace_active.load(memory_order_relaxed))
+			return -1;
+		trace_active.store(false, memory_order_relaxed);
+		events.swap(trace_events);
+		file = trace_file;
+	}
+
+	obs_data_array_t *array = obs_data_array_create();
+	// pid 0 is for the work that is not for one canvas
+	map<string, long long> pids;
+	pids[""] = 0;
+	add_trace_metadata(array, "process_name", 0, 0, "Transition Table");
+	map<thread::id, long long> tids;
+	// chrome only shows thread names per process
+	set<pair<long long, long long>> named_threads;
+	for (const auto &e : events) {
+		auto pid_it = pids.find(e.canvas);
+		if (pid_it == pids.end()) {
+			pid_it = pids.emplace(e.canvas, (long long)pids.size()).first;
+			add_trace_metadata(array, "process_name", pid_it->second, 0, ("Canvas " + e.canvas).c_str());
+		}
+		auto tid_it = tids.find(e.thread_id);
+		if (tid_it == tids.end())
+			tid_it = tids.emplace(e.thread_id, (long long)tids.size() + 1).first;
+		if (named_threads.emplace(pid_it->second, tid_it->second).second) {
+			string threadName = e.thread_name ? e.thread_name : "thread " + to_string(tid_it->second);
+			add_trace_metadata(array, "thread_name", pid_it->second, tid_it->second, threadName.c_str());
+		}
+		obs_data_t *event = obs_data_create();
+		obs_data_set_string(event, "name", e.name);
+		obs_data_set_string(event, "cat", "transition-table");
+		obs_data_set_string(event, "ph", "X");
+		// microseconds on the clock of os_gettime_ns
+		obs_data_set_double(event, "ts", (double)e.start / 1000.0);
+		obs_data_set_double(event, "dur", (double)(e.end - e.start) / 1000.0);
+		obs_data_set_int(event, "pid", pid_it->second);
+		obs_data_set_int(event, "tid", tid_it->second);
+		obs_data_array_push_back(array, event);
+		obs_data_release(event);
+	}
+	obs_data_t *trace = obs_data_create();
+	obs_data_set_array(trace, "traceEvents", array);
+	obs_data_set_string(trace, "displayTimeUnit", "ms");
+	const bool saved = obs_data_save_json(trace, file.c_str());
+	obs_data_release(trace);
+	obs_data_array_release(array);
+	return saved ? (long long)events.size() : -1;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <obs.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+
+// Lock free latency histogram, bucket i counts durations from 2^i up to 2^(i+1) nanoseconds.
+// Recording only uses relaxed atomics so it can stay on during shows.
+class latency_histogram {
+public:
+	static const size_t bucket_count = 40;
+
+	void record(uint64_t ns);
+	void reset();
+
+	uint64_t count() const { return counted.load(std::memory_order_relaxed); }
+	uint64_t total_ns() const { return total.load(std::memory_order_relaxed); }
+	uint64_t max_ns() const { return maximum.load(std::memory_order_relaxed); }
+	// upper bound of the bucket the percentile falls in
+	uint64_t percentile_ns(double percentile) const;
+
+private:
+	std::atomic<uint64_t> buckets[bucket_count] = {};
+	std::atomic<uint64_t> counted{0};
+	std::atomic<uint64_t> total{0};
+	std::atomic<uint64_t> maximum{0};
+};
+
+struct transition_stats {
+	// one from/to pair through the decision table
+	latency_histogram resolve;
+	// set_transition_overrides_queued
+	latency_histogram override_pass;
+	// between obs_queue_task and the override pass running
+	latency_histogram queue_wait;
+	latency_histogram save;
+	latency_histogram load;
+	latency_histogram refresh_table;
+	std::atomic<uint64_t> scenes_scanned{0};
+	std::atomic<uint64_t> overrides_written{0};
+};
+
+extern transition_stats stats;
+
+inline void add_stat(std::atomic<uint64_t> &counter, uint64_t value)
+{
+	counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+class stats_timer {
+public:
+	explicit stats_timer(latency_histogram &histogram) : histogram(histogram), start(os_gettime_ns()) {}
+	~stats_timer() { histogram.record(os_gettime_ns() - start); }
+
+private:
+	latency_histogram &histogram;
+	uint64_t start;
+};
+
+void reset_stats();
+void histogram_to_data(const latency_histogram &histogram, obs_data_t *obj);
+void stats_to_data(obs_data_t *data);
+std::string stats_summary();
+
+extern std::atomic<bool> trace_active;
+
+inline bool trace_recording()
+{
+	return trace_active.load(std::memory_order_relaxed);
+}
+
+// Records Chrome trace events until stop_trace writes them to the file, every canvas is its own process
+// and every plugin thread its own thread so the spans line up with the frame timing of OBS.
+bool start_trace(const std::string &file);
+// returns the number of events written or -1 when nothing was recording or the file could not be written
+long long stop_trace(std::string &file);
+void record_trace_event(const char *name, const char *canvas, uint64_t start, uint64_t end);
+
+// OBS profiler scope that is also recorded while a trace is recording, the name must be a static string
+class profile_scope {
+public:
+	explicit profile_scope(const char *name, const char *canvas = nullptr)
+		: name(name),
+		  canvas(canvas),
+		  start(trace_recording() ? os_gettime_ns() : 0)
+	{
+		profile_start(name);
+	}
+	~profile_scope()
+	{
+		profile_end(name);
+		if (start && trace_recording())
+			record_trace_event(name, canvas, start, os_gettime_ns());
+	}
+	// the canvas name must outlive the scope
+	void set_canvas(const char *canvasName) { canvas = canvasName; }
+
+private:
+	const char *name;
+	const char *canvas;
+	uint64_t start;
+};
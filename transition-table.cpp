@@ -1,23 +1,43 @@
 
 #include "obs-websocket-api.h"
+#include "transition-log.hpp"
+#include "transition-rules.hpp"
+#include "transition-stats.hpp"
 #include "transition-table.hpp"
+#include "transition-threads.hpp"
 #include "version.h"
 #include <obs-frontend-api.h>
 #include <obs-module.h>
 #include <QCheckBox>
 #include <QComboBox>
+#include <QDateTime>
 #include <QCompleter>
 #include <QFileDialog>
+#include <QFileSystemWatcher>
 #include <QFormLayout>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QLabel>
+#include <QListWidget>
+#include <QMessageBox>
 #include <QMouseEvent>
+#include <QPointer>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QSignalBlocker>
 #include <QSpinBox>
 #include <QTableView>
 #include <QTableWidget>
+#include <QTimer>
 #include <QtWidgets/QColorDialog>
 #include <QVBoxLayout>
+#include <algorithm>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <set>
+#include <thread>
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_AUTHOR("Exeldro");
@@ -25,20 +45,127 @@ OBS_MODULE_USE_DEFAULT_LOCALE("transition-table", "en-US")
 
 using namespace std;
 
-struct transition_info {
-	string transition;
-	int duration;
+struct transition_rule {
+	string canvas;
+	string from_scene;
+	string to_scene;
+	transition_info info;
+};
+
+struct transition_change {
+	string canvas;
+	string from_scene;
+	string to_scene;
+	bool remove;
+	transition_info info;
+};
+
+enum import_mode {
+	IMPORT_MODE_REPLACE,
+	IMPORT_MODE_MERGE,
+	IMPORT_MODE_KEEP_EXISTING,
 };
 
-map<string, map<string, map<string, transition_info>>> transition_table;
+map<string, transition_rules> transition_table;
+
+// per canvas transitions as loaded from the scene collection, only parsed when the canvas is used
+map<string, obs_data_array_t *> pending_transitions;
 
 map<string, vector<string>> canvas_transitions;
 
+// canvas name -> json file the transitions of that canvas are kept in sync with
+map<string, string> linked_files;
+static QFileSystemWatcher *linked_files_watcher = nullptr;
+
 int transition_table_width = 0;
 int transition_table_height = 0;
 
 obs_hotkey_pair_id transition_table_hotkey = OBS_INVALID_HOTKEY_PAIR_ID;
 
+// results of the last lint run per canvas, only used on the UI thread
+map<string, vector<lint_issue>> lint_results;
+map<string, vector<lint_issue>> cross_canvas_lint_results;
+static QObject *lint_context = nullptr;
+
+static set<string> lint_dirty;
+// what the cross canvas lint last saw of each canvas, only the dirty canvases are copied again
+struct lint_canvas_input {
+	shared_ptr<const transition_rules> rules;
+	shared_ptr<const set<string>> scenes;
+};
+static map<string, lint_canvas_input> lint_inputs;
+// (canvas, other canvas) -> issues of the rules of canvas against other canvas
+static map<pair<string, string>, vector<lint_issue>> cross_canvas_pair_results;
+static bool lint_running = false;
+// results of a run started before the scene collection changed are dropped
+static uint64_t lint_generation = 0;
+static QPointer<TransitionTableDialog> table_dialog;
+
+static void log_memory_usage();
+
+// seconds between statistics in the log, 0 is off
+static int stats_log_interval = 0;
+static QTimer *stats_log_timer = nullptr;
+
+static void set_stats_log_interval(int seconds)
+{
+	stats_log_interval = std::max(seconds, 0);
+	if (!stats_log_timer) {
+		if (!stats_log_interval || !lint_context)
+			return;
+		stats_log_timer = new QTimer(lint_context);
+		QObject::connect(stats_log_timer, &QTimer::timeout, [] {
+			blog(LOG_INFO, "[Transition Table] stats: %s", stats_summary().c_str());
+			log_memory_usage();
+		});
+	}
+	if (stats_log_interval)
+		stats_log_timer->start(stats_log_interval * 1000);
+	else
+		stats_log_timer->stop();
+}
+
+static void run_lint();
+static void log_rules_snapshot(const string &canvasName);
+static void log_rule_changes(const vector<transition_change> &changes);
+
+// the UI thread of OBS and Qt, lint_context is gone once the module unloads
+static const ui_thread_host obs_ui_thread_host = {
+	[] { return obs_in_task_thread(OBS_TASK_UI); },
+	[] { return obs_in_task_thread(OBS_TASK_GRAPHICS) || obs_in_task_thread(OBS_TASK_AUDIO); },
+	[](function<void()> f) {
+		obs_queue_task(
+			OBS_TASK_UI,
+			[](void *param) {
+				auto f = (function<void()> *)param;
+				(*f)();
+				delete f;
+			},
+			new function<void()>(std::move(f)), false);
+	},
+	[](const function<void()> &f) {
+		if (!lint_context)
+			return false;
+		QMetaObject::invokeMethod(lint_context, [&f] { f(); }, Qt::BlockingQueuedConnection);
+		return true;
+	},
+	[](const char *message) { blog(LOG_ERROR, "[Transition Table] %s", message); },
+};
+
+// the canvas is linted again on a worker thread once the UI thread gets to it
+static void schedule_lint(const string &canvasName)
+{
+	if (!lint_context)
+		return;
+	QMetaObject::invokeMethod(
+		lint_context,
+		[canvasName] {
+			lint_dirty.insert(canvasName);
+			run_lint();
+		},
+		Qt::QueuedConnection);
+}
+
 static void load_transition_matrix(obs_data_t *obj)
 {
 	obs_data_array_t *transitions = obs_data_get_array(obj, "matrix");
@@ -70,7 +197,204 @@ static void load_transition_matrix(obs_data_t *obj)
 	obs_data_array_release(transitions);
 }
 
-static void load_transitions(obs_data_t *obj, const char *canvas_name)
+map<string, scene_group_table> scene_groups;
+
+struct canvas_settings {
+	enum rule_precedence precedence = RULE_PRECEDENCE_FROM_SCENE;
+	// active profile, "" is the default profile
+	string profile;
+	bool enabled = true;
+	obs_hotkey_pair_id hotkey = OBS_INVALID_HOTKEY_PAIR_ID;
+	// key of the shared rules the own rules are layered on, "" for none
+	string shared_rules;
+	// overrides are only resolved for the scene a switch is prepared for
+	bool on_demand = false;
+};
+
+map<string, canvas_settings> canvas_settings_map;
+
+// for reading, does not add an entry for shared rules or canvases without settings
+static const canvas_settings &get_canvas_settings(const string &canvasName)
+{
+	static const canvas_settings defaults;
+	auto it = canvas_settings_map.find(canvasName);
+	return it == canvas_settings_map.end() ? defaults : it->second;
+}
+
+static canvas_settings &register_canvas_hotkeys(const string &canvasName);
+
+// settings to change, only for canvases OBS has or settings were loaded for, requests can name any canvas
+static canvas_settings *edit_canvas_settings(const string &canvasName)
+{
+	if (!on_ui_thread(__func__))
+		return nullptr;
+	if (canvas_settings_map.find(canvasName) == canvas_settings_map.end()) {
+		obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+		if (!c)
+			return nullptr;
+		obs_canvas_release(c);
+	}
+	return &register_canvas_hotkeys(canvasName);
+}
+
+// compiled from transition_table, dropped whenever the rules or groups of the canvas change
+map<string, unique_ptr<transition_decision_table>> decision_tables;
+
+// bumped whenever any canvas may resolve differently
+static uint64_t rules_version = 0;
+
+// every scene pair of a canvas resolved, for get_matrix
+struct resolved_matrix {
+	uint64_t rules_version = 0;
+	// handed to clients to ask whether the matrix changed
+	uint64_t version = 0;
+	vector<string> scenes;
+	// distinct transition and duration pairs
+	vector<transition_info> palette;
+	// from scene * scenes + to scene -> index in palette + 1, 0 is no rule
+	vector<uint32_t> cells;
+};
+
+static map<string, resolved_matrix> resolved_matrices;
+static uint64_t resolved_matrix_version = 0;
+
+struct rule_usage {
+	uint64_t hits = 0;
+	// seconds since the epoch
+	int64_t last_used = 0;
+};
+
+// canvas or shared rules key -> (from key, to key) -> usage, counted when a transition starts
+static map<string, map<pair<string, string>, rule_usage>> rule_usage_table;
+// saved with the scene collection
+static bool persist_rule_usage = false;
+
+static const rule_usage *find_rule_usage(const string &key, const string &from_key, const string &to_key)
+{
+	auto it = rule_usage_table.find(key);
+	if (it == rule_usage_table.end())
+		return nullptr;
+	auto it2 = it->second.find({from_key, to_key});
+	return it2 == it->second.end() ? nullptr : &it2->second;
+}
+
+static void rename_scene_in_usage(const string &key, const string &prev_name, const string &new_name)
+{
+	auto it = rule_usage_table.find(key);
+	if (it == rule_usage_table.end())
+		return;
+	map<pair<string, string>, rule_usage> renamed;
+	for (const auto &usage : it->second) {
+		pair<string, string> keys = usage.first;
+		if (keys.first == prev_name)
+			keys.first = new_name;
+		if (keys.second == prev_name)
+			keys.second = new_name;
+		renamed[keys] = usage.second;
+	}
+	it->second = std::move(renamed);
+}
+
+struct rule_profile {
+	string canvas;
+	string name;
+	// empty for the active profile, its rules are in transition_table
+	transition_rules rules;
+	unique_ptr<transition_decision_table> table;
+	obs_hotkey_id hotkey = OBS_INVALID_HOTKEY_ID;
+};
+
+// canvas -> profile name -> profile
+map<string, map<string, rule_profile>> canvas_profiles;
+
+static vector<string> get_group_scenes(const string &canvasName, const string &group)
+{
+	vector<string> scenes;
+	auto it = scene_groups.find(canvasName);
+	if (it == scene_groups.end())
+		return scenes;
+	auto group_it = it->second.groups.find(group);
+	if (group_it == it->second.groups.end())
+		return scenes;
+	for (size_t id = 0; id < it->second.scene_names.size(); id++) {
+		if (scene_in_group(group_it->second, id))
+			scenes.push_back(it->second.scene_names[id]);
+	}
+	return scenes;
+}
+
+static void set_group_scenes(const string &canvasName, const string &group, const vector<string> &scenes)
+{
+	auto &sgt = scene_groups[canvasName];
+	vector<uint64_t> members;
+	for (const auto &sceneName : scenes) {
+		const size_t id = intern_group_scene(sgt, sceneName);
+		if (members.size() <= id / 64)
+			members.resize(id / 64 + 1);
+		members[id / 64] |= (uint64_t)1 << (id % 64);
+	}
+	sgt.groups[group] = std::move(members);
+}
+
+// shared rules are stored in transition_table like a canvas, under "shared:<name>"
+static bool is_shared_rules(const string &key)
+{
+	return key.compare(0, 7, "shared:") == 0;
+}
+
+// logged is set when the switch log already has the changes, otherwise the whole rules are logged
+static void transition_table_changed(const string &canvasName, bool logged = false)
+{
+	if (!logged && switch_log_recording())
+		log_rules_snapshot(canvasName);
+	decision_tables.erase(canvasName);
+	rules_version++;
+	schedule_lint(canvasName);
+	if (!is_shared_rules(canvasName))
+		return;
+	// every canvas using the shared rules has them compiled into its tables
+	for (const auto &it : canvas_settings_map) {
+		if (it.second.shared_rules != canvasName)
+			continue;
+		decision_tables.erase(it.first);
+		schedule_lint(it.first);
+		auto profiles_it = canvas_profiles.find(it.first);
+		if (profiles_it == canvas_profiles.end())
+			continue;
+		for (auto &profile : profiles_it->second)
+			profile.second.table.reset();
+	}
+}
+
+// groups and precedence are shared by all profiles of a canvas
+static void canvas_rules_context_changed(const string &canvasName)
+{
+	transition_table_changed(canvasName);
+	auto it = canvas_profiles.find(canvasName);
+	if (it == canvas_profiles.end())
+		return;
+	for (auto &profile : it->second)
+		profile.second.table.reset();
+}
+
+static obs_data_array_t *rules_to_array(const transition_rules &rules)
+{
+	obs_data_array_t *transitions = obs_data_array_create();
+	for (const auto &from : rules) {
+		for (const auto &to : from.second) {
+			obs_data_t *transition = obs_data_create();
+			obs_data_set_string(transition, "from_scene", from.first.c_str());
+			obs_data_set_string(transition, "to_scene", to.first.c_str());
+			obs_data_set_string(transition, "transition", to.second.transition.c_str());
+			obs_data_set_int(transition, "duration", to.second.duration);
+			obs_data_array_push_back(transitions, transition);
+			obs_data_release(transition);
+		}
+	}
+	return transitions;
+}
+
+static void load_transitions_pending(obs_data_t *obj, const char *canvas_name)
 {
 	obs_data_array_t *transitions = obs_data_get_array(obj, "transitions");
 	if (!transitions)
@@ -78,119 +402,1300 @@ static void load_transitions(obs_data_t *obj, const char *canvas_name)
 	const size_t count = obs_data_array_count(transitions);
 	for (size_t i = 0; i < count; i++) {
 		obs_data_t *transition = obs_data_array_item(transitions, i);
-		string canvasName = obs_data_get_string(transition, "canvas");
-		if (canvasName.empty())
+		const char *canvasName = obs_data_get_string(transition, "canvas");
+		if (!canvasName || !*canvasName)
 			canvasName = canvas_name;
+		auto it = pending_transitions.find(canvasName);
+		if (it == pending_transitions.end())
+			it = pending_transitions.emplace(canvasName, obs_data_array_create()).first;
+		obs_data_array_push_back(it->second, transition);
+		obs_data_release(transition);
+	}
+	obs_data_array_release(transitions);
+}
+
+// the read paths materialize too, so every reader of the table has to be on the UI thread
+static void materialize_transitions(const string &canvasName)
+{
+	if (!on_ui_thread(__func__))
+		return;
+	auto it = pending_transitions.find(canvasName);
+	if (it == pending_transitions.end())
+		return;
+	obs_data_array_t *transitions = it->second;
+	pending_transitions.erase(it);
+	auto &canvas_table = transition_table[canvasName];
+	const size_t count = obs_data_array_count(transitions);
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *transition = obs_data_array_item(transitions, i);
 		string fromScene = obs_data_get_string(transition, "from_scene");
 		string toScene = obs_data_get_string(transition, "to_scene");
-		string transitionName = obs_data_get_string(transition, "transition");
-		const uint32_t duration = obs_data_get_int(transition, "duration");
-		transition_table[canvasName][fromScene][toScene].transition = transitionName;
-		transition_table[canvasName][fromScene][toScene].duration = duration;
+		auto &t = canvas_table[fromScene][toScene];
+		t.transition = obs_data_get_string(transition, "transition");
+		t.duration = (int)obs_data_get_int(transition, "duration");
 		obs_data_release(transition);
 	}
 	obs_data_array_release(transitions);
+	transition_table_changed(canvasName);
+}
+
+static void materialize_all_transitions()
+{
+	if (!on_ui_thread(__func__))
+		return;
+	while (!pending_transitions.empty())
+		materialize_transitions(pending_transitions.begin()->first);
+}
+
+static void unlink_file(const string &canvasName)
+{
+	auto it = linked_files.find(canvasName);
+	if (it == linked_files.end())
+		return;
+	const string file = it->second;
+	linked_files.erase(it);
+	for (const auto &it2 : linked_files) {
+		if (it2.second == file)
+			return;
+	}
+	linked_files_watcher->removePath(QString::fromUtf8(file.c_str()));
+}
+
+static void clear_transitions()
+{
+	lint_results.clear();
+	cross_canvas_lint_results.clear();
+	lint_dirty.clear();
+	lint_inputs.clear();
+	cross_canvas_pair_results.clear();
+	lint_generation++;
+	for (auto &it : pending_transitions)
+		obs_data_array_release(it.second);
+	pending_transitions.clear();
+	transition_table.clear();
+	decision_tables.clear();
+	resolved_matrices.clear();
+	rules_version++;
+	rule_usage_table.clear();
+	for (auto &it : canvas_profiles) {
+		for (auto &profile : it.second)
+			obs_hotkey_unregister(profile.second.hotkey);
+	}
+	canvas_profiles.clear();
+	scene_groups.clear();
+	for (auto &it : canvas_settings_map)
+		obs_hotkey_pair_unregister(it.second.hotkey);
+	canvas_settings_map.clear();
+	canvas_transitions.clear();
+	while (!linked_files.empty())
+		unlink_file(linked_files.begin()->first);
+}
+
+static map<string, transition_rules>::iterator find_canvas_table(const string &canvasName)
+{
+	materialize_transitions(canvasName);
+	return transition_table.find(canvasName);
+}
+
+static transition_rules &get_canvas_table(const string &canvasName)
+{
+	materialize_transitions(canvasName);
+	return transition_table[canvasName];
+}
+
+static const transition_rules *find_shared_rules(const string &canvasName)
+{
+	auto cs_it = canvas_settings_map.find(canvasName);
+	if (cs_it == canvas_settings_map.end() || cs_it->second.shared_rules.empty())
+		return nullptr;
+	auto it = find_canvas_table(cs_it->second.shared_rules);
+	return it == transition_table.end() ? nullptr : &it->second;
+}
+
+// like find_canvas_table, but a canvas without own rules that uses shared rules gets an empty table
+// nothing off the UI thread, the compiled tables are dropped there whenever the rules change
+static transition_rules *find_resolve_table(const string &canvasName)
+{
+	if (!on_ui_thread(__func__))
+		return nullptr;
+	auto it = find_canvas_table(canvasName);
+	if (it != transition_table.end())
+		return &it->second;
+	if (!find_shared_rules(canvasName))
+		return nullptr;
+	return &transition_table[canvasName];
+}
+
+// canvas_table comes from find_resolve_table, which keeps this on the UI thread
+static transition_decision_table &get_decision_table(const string &canvasName, const transition_rules &canvas_table)
+{
+	auto &dt = decision_tables[canvasName];
+	if (dt)
+		return *dt;
+	dt = make_unique<transition_decision_table>();
+	auto sg_it = scene_groups.find(canvasName);
+	dt->compile(canvas_table, find_shared_rules(canvasName), sg_it == scene_groups.end() ? nullptr : &sg_it->second,
+		    get_canvas_settings(canvasName).precedence);
+	for (const auto &error : dt->errors())
+		blog(LOG_WARNING, "[Transition Table] %s", error.c_str());
+	return *dt;
+}
+
+static bool transition_rule_less(const transition_rule &a, const transition_rule &b)
+{
+	int c = a.canvas.compare(b.canvas);
+	if (c == 0)
+		c = a.from_scene.compare(b.from_scene);
+	if (c == 0)
+		c = a.to_scene.compare(b.to_scene);
+	return c < 0;
+}
+
+// does not touch the transition table so it can run on a worker thread
+// progress is called with the rules read so far, every 1000 rules
+static void read_transition_rules(obs_data_t *obj, const char *canvas_name, vector<transition_rule> &rules,
+				  const function<void(size_t done, size_t count)> &progress = nullptr)
+{
+	obs_data_array_t *transitions = obs_data_get_array(obj, "transitions");
+	if (!transitions)
+		return;
+	const size_t count = obs_data_array_count(transitions);
+	rules.reserve(rules.size() + count);
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *transition = obs_data_array_item(transitions, i);
+		transition_rule rule;
+		rule.canvas = obs_data_get_string(transition, "canvas");
+		if (rule.canvas.empty())
+			rule.canvas = canvas_name;
+		rule.from_scene = obs_data_get_string(transition, "from_scene");
+		rule.to_scene = obs_data_get_string(transition, "to_scene");
+		rule.info.transition = obs_data_get_string(transition, "transition");
+		rule.info.duration = (int)obs_data_get_int(transition, "duration");
+		rules.push_back(std::move(rule));
+		obs_data_release(transition);
+		if (progress && i % 1000 == 0)
+			progress(i, count);
+	}
+	obs_data_array_release(transitions);
+	// stable so the last of duplicate rules still wins
+	stable_sort(rules.begin(), rules.end(), transition_rule_less);
+}
+
+static bool canvas_enabled(const string &canvasName)
+{
+	auto it = canvas_settings_map.find(canvasName);
+	return it == canvas_settings_map.end() || it->second.enabled;
+}
+
+static bool canvas_has_scene(const string &canvasName, const string &sceneName)
+{
+	obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+	if (!c)
+		return false;
+	obs_source_t *scene = obs_canvas_get_source_by_name(c, sceneName.c_str());
+	obs_source_release(scene);
+	obs_canvas_release(c);
+	return scene != nullptr;
+}
+
+static string get_current_scene_name(obs_canvas_t *canvas)
+{
+	obs_source_t *scene = obs_canvas_get_channel(canvas, 0);
+	if (scene && obs_source_get_type(scene) == OBS_SOURCE_TYPE_TRANSITION) {
+		obs_source_release(scene);
+		scene = obs_transition_get_active_source(scene);
+	}
+	string sceneName;
+	if (scene) {
+		sceneName = obs_source_get_name(scene);
+		obs_source_release(scene);
+	}
+	return sceneName;
+}
+
+// resolving fills the pattern matches and resolved pairs cached in the table, the UI thread owns them
+static const transition_info *resolve_timed(transition_decision_table &dt, const string &fromScene, const string &toScene)
+{
+	if (!on_ui_thread(__func__))
+		return nullptr;
+	stats_timer timer(stats.resolve);
+	return dt.resolve(fromScene, toScene);
+}
+
+// returns if anything was written
+static bool write_transition_override(obs_source_t *scene, const transition_info *t)
+{
+	obs_data_t *data = obs_source_get_private_settings(scene);
+	bool written = false;
+	// only write what changed
+	if (!t) {
+		if (obs_data_has_user_value(data, "transition")) {
+			obs_data_erase(data, "transition");
+			written = true;
+		}
+	} else {
+		if (t->transition != obs_data_get_string(data, "transition")) {
+			obs_data_set_string(data, "transition", t->transition.c_str());
+			written = true;
+		}
+		if (t->duration != obs_data_get_int(data, "transition_duration")) {
+			obs_data_set_int(data, "transition_duration", t->duration);
+			written = true;
+		}
+	}
+	obs_data_release(data);
+	if (written)
+		add_stat(stats.overrides_written, 1);
+	return written;
+}
+
+static void clear_transition_overrides(obs_canvas_t *canvas)
+{
+	obs_canvas_enum_scenes(
+		canvas,
+		[](void *param, obs_source_t *scene) {
+			UNUSED_PARAMETER(param);
+			obs_data_t *data = obs_source_get_private_settings(scene);
+			obs_data_erase(data, "transition");
+			obs_data_release(data);
+			return true;
+		},
+		nullptr);
+}
+
+static void set_transition_overrides_queued(obs_canvas_t *canvas)
+{
+	if (obs_canvas_removed(canvas))
+		return;
+
+	string canvasName = obs_canvas_get_name(canvas);
+	profile_scope scope("transition_table_set_overrides", canvasName.c_str());
+	// the canvas can be disabled after the task was queued
+	if (!canvas_enabled(canvasName))
+		return;
+	auto canvas_table = find_resolve_table(canvasName);
+	if (!canvas_table)
+		return;
+
+	string fromScene = get_current_scene_name(canvas);
+	stats_timer timer(stats.override_pass);
+	auto &dt = get_decision_table(canvasName, *canvas_table);
+
+	vector<obs_source_t *> scenes;
+	obs_canvas_enum_scenes(
+		canvas,
+		[](void *param, obs_source_t *scene) {
+			auto scenes = (vector<obs_source_t *> *)param;
+			scenes->push_back(obs_source_get_ref(scene));
+			return true;
+		},
+		&scenes);
+
+	for (size_t i = 0; i < scenes.size(); i++) {
+		string toScene = obs_source_get_name(scenes[i]);
+		write_transition_override(scenes[i], resolve_timed(dt, fromScene, toScene));
+		obs_source_release(scenes[i]);
+	}
+	add_stat(stats.scenes_scanned, scenes.size());
+}
+
+// in studio mode the preview scene is the only scene the next transition goes to
+static bool studio_mode_targeted = false;
+static bool studio_mode_active = false;
+// the other scenes of the main canvas still have the overrides of an older program scene
+static bool studio_overrides_stale = false;
+
+// must run on the UI thread
+static void set_preview_override()
+{
+	obs_source_t *preview = obs_frontend_get_current_preview_scene();
+	if (!preview)
+		return;
+	obs_canvas_t *mc = obs_get_main_canvas();
+	string canvasName = obs_canvas_get_name(mc);
+	profile_scope scope("transition_table_preview_override", canvasName.c_str());
+	auto canvas_table = canvas_enabled(canvasName) ? find_resolve_table(canvasName) : nullptr;
+	if (canvas_table) {
+		auto &dt = get_decision_table(canvasName, *canvas_table);
+		write_transition_override(preview, resolve_timed(dt, get_current_scene_name(mc), obs_source_get_name(preview)));
+	}
+	obs_canvas_release(mc);
+	obs_source_release(preview);
+}
+
+static bool is_main_canvas(obs_canvas_t *canvas)
+{
+	obs_canvas_t *mc = obs_get_main_canvas();
+	const bool main = mc == canvas;
+	obs_canvas_release(mc);
+	return main;
+}
+
+// the frontend reads the overrides of the main canvas without asking, so it always gets the full pass
+static bool canvas_on_demand(obs_canvas_t *canvas)
+{
+	auto it = canvas_settings_map.find(obs_canvas_get_name(canvas));
+	return it != canvas_settings_map.end() && it->second.on_demand && !is_main_canvas(canvas);
+}
+
+static bool studio_mode_targeting(obs_canvas_t *canvas)
+{
+	if (!studio_mode_targeted || !studio_mode_active)
+		return false;
+	return is_main_canvas(canvas);
+}
+
+// studio mode and on demand canvases get no full pass
+static bool override_pass_deferred(obs_canvas_t *canvas)
+{
+	if (studio_mode_targeting(canvas)) {
+		// the full pass waits until studio mode ends
+		studio_overrides_stale = true;
+		obs_queue_task(OBS_TASK_UI, [](void *) { set_preview_override(); }, nullptr, false);
+		return true;
+	}
+	return canvas_on_demand(canvas);
+}
+
+static void set_transition_overrides(obs_canvas_t *canvas)
+{
+	if (obs_canvas_removed(canvas) || override_pass_deferred(canvas))
+		return;
+	struct queued_overrides {
+		obs_canvas_t *canvas;
+		uint64_t queued;
+	};
+	// on the UI thread with the tables, which also keeps the pass out of the render loop
+	obs_queue_task(
+		OBS_TASK_UI,
+		[](void *param) {
+			auto queued = (queued_overrides *)param;
+			stats.queue_wait.record(os_gettime_ns() - queued->queued);
+			set_transition_overrides_queued(queued->canvas);
+			delete queued;
+		},
+		new queued_overrides{canvas, os_gettime_ns()}, false);
+}
+
+static void set_studio_mode_targeted(bool targeted)
+{
+	studio_mode_targeted = targeted;
+	if (studio_mode_targeted && studio_mode_active) {
+		set_preview_override();
+		return;
+	}
+	if (!studio_overrides_stale)
+		return;
+	studio_overrides_stale = false;
+	obs_canvas_t *mc = obs_get_main_canvas();
+	if (canvas_enabled(obs_canvas_get_name(mc)))
+		set_transition_overrides(mc);
+	obs_canvas_release(mc);
+}
+
+// resolves the transition from the current scene and writes the override of only the target scene
+static bool prepare_switch(const string &canvasName, const string &toScene, transition_info &info)
+{
+	if (!on_ui_thread(__func__))
+		return false;
+	profile_scope scope("transition_table_prepare_switch", canvasName.c_str());
+	if (switch_log_recording())
+		switch_log_write(SWITCH_LOG_PREPARE_SWITCH, canvasName, toScene);
+	obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+	if (!c)
+		return false;
+	const transition_info *t = nullptr;
+	auto canvas_table = canvas_enabled(canvasName) ? find_resolve_table(canvasName) : nullptr;
+	if (canvas_table)
+		t = resolve_timed(get_decision_table(canvasName, *canvas_table), get_current_scene_name(c), toScene);
+	obs_source_t *scene = obs_canvas_get_source_by_name(c, toScene.c_str());
+	if (scene) {
+		write_transition_override(scene, t);
+		obs_source_release(scene);
+	}
+	obs_canvas_release(c);
+	if (t)
+		info = *t;
+	return t != nullptr;
+}
+
+static void set_canvas_on_demand(const string &canvasName, bool on_demand)
+{
+	auto cs = edit_canvas_settings(canvasName);
+	if (!cs || cs->on_demand == on_demand)
+		return;
+	cs->on_demand = on_demand;
+	obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+	if (!c)
+		return;
+	// overrides of a full pass would go stale, without the full pass they are written when a switch is prepared
+	if (on_demand && canvas_on_demand(c))
+		clear_transition_overrides(c);
+	else if (canvas_enabled(canvasName))
+		set_transition_overrides(c);
+	obs_canvas_release(c);
+}
+
+static bool table_references_key(const transition_rules &canvas_table, const string &key)
+{
+	if (canvas_table.find(key) != canvas_table.end())
+		return true;
+	for (const auto &from : canvas_table) {
+		if (from.second.find(key) != from.second.end())
+			return true;
+	}
+	return false;
+}
+
+static void update_canvas_overrides(const string &canvasName)
+{
+	if (is_shared_rules(canvasName)) {
+		for (const auto &it : canvas_settings_map) {
+			if (it.second.shared_rules == canvasName)
+				update_canvas_overrides(it.first);
+		}
+		return;
+	}
+	if (!canvas_enabled(canvasName))
+		return;
+	obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+	if (!c)
+		return;
+	set_transition_overrides(c);
+	obs_canvas_release(c);
+}
+
+static void set_shared_rules(const string &canvasName, const string &key)
+{
+	if (is_shared_rules(canvasName))
+		return;
+	auto cs = edit_canvas_settings(canvasName);
+	if (!cs || cs->shared_rules == key)
+		return;
+	cs->shared_rules = key;
+	auto shared_it = key.empty() ? transition_table.end() : find_canvas_table(key);
+	auto canvas_it = find_canvas_table(canvasName);
+	if (shared_it != transition_table.end() && canvas_it != transition_table.end()) {
+		// own rules that equal the shared ones are dropped, only real overrides stay
+		for (auto from_it = canvas_it->second.begin(); from_it != canvas_it->second.end();) {
+			auto shared_from_it = shared_it->second.find(from_it->first);
+			if (shared_from_it != shared_it->second.end()) {
+				for (auto to_it = from_it->second.begin(); to_it != from_it->second.end();) {
+					auto shared_to_it = shared_from_it->second.find(to_it->first);
+					if (shared_to_it != shared_from_it->second.end() && shared_to_it->second == to_it->second)
+						to_it = from_it->second.erase(to_it);
+					else
+						++to_it;
+				}
+			}
+			if (from_it->second.empty())
+				from_it = canvas_it->second.erase(from_it);
+			else
+				++from_it;
+		}
+	}
+	canvas_rules_context_changed(canvasName);
+	update_canvas_overrides(canvasName);
+}
+
+// the rules of the canvas move to new shared rules, returns the key or "" when the name is taken
+static string create_shared_rules(const string &canvasName, const string &name)
+{
+	const string key = "shared:" + name;
+	if (name.empty() || is_shared_rules(canvasName) || find_canvas_table(key) != transition_table.end())
+		return string();
+	auto &canvas_table = get_canvas_table(canvasName);
+	transition_table[key] = std::move(canvas_table);
+	canvas_table.clear();
+	set_shared_rules(canvasName, key);
+	return key;
+}
+
+static vector<string> get_shared_rules_keys()
+{
+	vector<string> keys;
+	for (const auto &it : transition_table) {
+		if (is_shared_rules(it.first))
+			keys.push_back(it.first);
+	}
+	for (const auto &it : pending_transitions) {
+		if (is_shared_rules(it.first))
+			keys.push_back(it.first);
+	}
+	sort(keys.begin(), keys.end());
+	return keys;
+}
+
+// only canvases with rules using the group need new overrides
+static void scene_group_changed(const string &canvasName, const string &group)
+{
+	auto profiles_it = canvas_profiles.find(canvasName);
+	if (profiles_it != canvas_profiles.end()) {
+		for (auto &profile : profiles_it->second)
+			profile.second.table.reset();
+	}
+	auto canvas_it = find_canvas_table(canvasName);
+	auto shared = find_shared_rules(canvasName);
+	if ((canvas_it == transition_table.end() || !table_references_key(canvas_it->second, group)) &&
+	    (!shared || !table_references_key(*shared, group)))
+		return;
+	transition_table_changed(canvasName);
+	update_canvas_overrides(canvasName);
+}
+
+// the rules and compiled table of the active profile are swapped with the stored ones, no recompile needed
+static bool switch_profile(const string &canvasName, const string &profileName)
+{
+	if (!on_ui_thread(__func__))
+		return false;
+	auto profiles_it = canvas_profiles.find(canvasName);
+	if (profiles_it == canvas_profiles.end())
+		return false;
+	auto it = profiles_it->second.find(profileName);
+	if (it == profiles_it->second.end())
+		return false;
+	// a canvas with profiles always gets its settings, with the hotkeys every other canvas has
+	auto &cs = register_canvas_hotkeys(canvasName);
+	if (cs.profile == profileName)
+		return true;
+	auto &active = get_canvas_table(canvasName);
+	auto &current = profiles_it->second[cs.profile];
+	swap(current.rules, active);
+	swap(current.table, decision_tables[canvasName]);
+	swap(active, it->second.rules);
+	swap(decision_tables[canvasName], it->second.table);
+	rules_version++;
+	cs.profile = profileName;
+	blog(LOG_INFO, "[Transition Table] switched canvas '%s' to profile '%s'", canvasName.c_str(), profileName.c_str());
+	update_canvas_overrides(canvasName);
+	return true;
+}
+
+static void profile_hotkey(void *data, obs_hotkey_id id, obs_hotkey_t *hotkey, bool pressed)
+{
+	UNUSED_PARAMETER(id);
+	UNUSED_PARAMETER(hotkey);
+	if (!pressed)
+		return;
+	// the profile can be removed before the UI thread gets to it
+	auto profile = (rule_profile *)data;
+	queue_on_ui_thread([canvasName = profile->canvas, profileName = profile->name] {
+		switch_profile(canvasName, profileName);
+	});
+}
+
+static rule_profile &add_profile(const string &canvasName, const string &profileName)
+{
+	auto &profiles = canvas_profiles[canvasName];
+	auto it = profiles.find(profileName);
+	if (it != profiles.end())
+		return it->second;
+	auto &profile = profiles[profileName];
+	profile.canvas = canvasName;
+	profile.name = profileName;
+	const string name = "transition-table.profile." + canvasName + "." + profileName;
+	const string description = string(obs_module_text("TransitionTable.Profile")) + " " + canvasName + " - " +
+				   (profileName.empty() ? obs_module_text("DefaultProfile") : profileName);
+	profile.hotkey = obs_hotkey_register_frontend(name.c_str(), description.c_str(), profile_hotkey, &profile);
+	// the default profile always exists once there are profiles
+	if (!profileName.empty())
+		add_profile(canvasName, "");
+	return profile;
+}
+
+static void remove_profile(const string &canvasName, const string &profileName)
+{
+	if (profileName.empty())
+		return;
+	auto profiles_it = canvas_profiles.find(canvasName);
+	if (profiles_it == canvas_profiles.end())
+		return;
+	auto it = profiles_it->second.find(profileName);
+	if (it == profiles_it->second.end())
+		return;
+	if (get_canvas_settings(canvasName).profile == profileName)
+		switch_profile(canvasName, "");
+	obs_hotkey_unregister(it->second.hotkey);
+	profiles_it->second.erase(it);
+}
+
+// rules must be sorted and all for the same canvas, adds the minimal set of changes to get that canvas in the imported state
+static void diff_canvas_rules(const string &canvasName, const transition_rule *begin, const transition_rule *end,
+			      enum import_mode mode, vector<transition_change> &changes)
+{
+	vector<pair<const string *, const map<string, transition_info>::value_type *>> existing;
+	auto canvas_it = find_canvas_table(canvasName);
+	if (canvas_it != transition_table.end()) {
+		for (const auto &from : canvas_it->second) {
+			for (const auto &to : from.second)
+				existing.emplace_back(&from.first, &to);
+		}
+	}
+	size_t j = 0;
+	for (auto rule = begin; rule != end; rule++) {
+		if (rule + 1 != end && rule[1].from_scene == rule->from_scene && rule[1].to_scene == rule->to_scene)
+			continue;
+		int c = 1;
+		while (j < existing.size()) {
+			c = existing[j].first->compare(rule->from_scene);
+			if (c == 0)
+				c = existing[j].second->first.compare(rule->to_scene);
+			if (c >= 0)
+				break;
+			if (mode == IMPORT_MODE_REPLACE)
+				changes.push_back({canvasName, *existing[j].first, existing[j].second->first, true, {}});
+			j++;
+		}
+		if (c == 0) {
+			const auto &info = existing[j].second->second;
+			if (mode != IMPORT_MODE_KEEP_EXISTING &&
+			    (info.transition != rule->info.transition || info.duration != rule->info.duration))
+				changes.push_back({canvasName, rule->from_scene, rule->to_scene, false, rule->info});
+			j++;
+		} else {
+			changes.push_back({canvasName, rule->from_scene, rule->to_scene, false, rule->info});
+		}
+	}
+	if (mode == IMPORT_MODE_REPLACE) {
+		for (; j < existing.size(); j++)
+			changes.push_back({canvasName, *existing[j].first, existing[j].second->first, true, {}});
+	}
+}
+
+// rules must be sorted, the result is the minimal set of changes to get the table in the imported state
+static vector<transition_change> diff_transition_rules(const vector<transition_rule> &rules, enum import_mode mode)
+{
+	vector<transition_change> changes;
+	size_t i = 0;
+	while (i < rules.size()) {
+		size_t end = i + 1;
+		while (end < rules.size() && rules[end].canvas == rules[i].canvas)
+			end++;
+		diff_canvas_rules(rules[i].canvas, rules.data() + i, rules.data() + end, mode, changes);
+		i = end;
+	}
+	return changes;
+}
+
+static void apply_transition_changes(const vector<transition_change> &changes)
+{
+	const bool logged = switch_log_recording();
+	if (logged)
+		log_rule_changes(changes);
+	map<string, set<string>> canvases;
+	for (const auto &change : changes) {
+		auto &canvas_table = get_canvas_table(change.canvas);
+		canvases[change.canvas].insert(change.from_scene);
+		if (!change.remove) {
+			canvas_table[change.from_scene][change.to_scene] = change.info;
+			continue;
+		}
+		auto fs_it = canvas_table.find(change.from_scene);
+		if (fs_it == canvas_table.end())
+			continue;
+		fs_it->second.erase(change.to_scene);
+		if (fs_it->second.empty())
+			canvas_table.erase(fs_it);
+	}
+	for (const auto &it : canvases)
+		transition_table_changed(it.first, logged);
+	for (const auto &it : canvases) {
+		if (is_shared_rules(it.first)) {
+			update_canvas_overrides(it.first);
+			continue;
+		}
+		if (!canvas_enabled(it.first))
+			continue;
+		obs_canvas_t *c = obs_get_canvas_by_name(it.first.c_str());
+		if (!c)
+			continue;
+		// the overrides only depend on the from rows of the current scene and Any
+		if (it.second.count("Any") || it.second.count(get_current_scene_name(c)))
+			set_transition_overrides(c);
+		obs_canvas_release(c);
+	}
+}
+
+static vector<string> get_canvas_scene_names(const string &canvasName)
+{
+	vector<string> scenes;
+	obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+	if (!c)
+		return scenes;
+	obs_canvas_enum_scenes(
+		c,
+		[](void *param, obs_source_t *scene) {
+			((vector<string> *)param)->push_back(obs_source_get_name(scene));
+			return true;
+		},
+		&scenes);
+	obs_canvas_release(c);
+	return scenes;
+}
+
+// everything minimize_transition_rules needs, copied so it can run on a worker thread
+struct rules_snapshot {
+	string canvas;
+	transition_rules rules;
+	bool has_base = false;
+	transition_rules base;
+	scene_group_table groups;
+	enum rule_precedence precedence = RULE_PRECEDENCE_FROM_SCENE;
+	vector<string> scenes;
+	vector<string> transitions;
+};
+
+// the transitions come from the frontend, so only the UI thread can take them
+static bool take_rules_snapshot(const string &canvasName, rules_snapshot &snapshot, bool with_transitions = true)
+{
+	// shared rules have no scenes of their own to check against
+	if (is_shared_rules(canvasName))
+		return false;
+	auto canvas_it = find_canvas_table(canvasName);
+	if (canvas_it == transition_table.end())
+		return false;
+	snapshot.canvas = canvasName;
+	snapshot.rules = canvas_it->second;
+	auto shared = find_shared_rules(canvasName);
+	snapshot.has_base = shared != nullptr;
+	if (shared)
+		snapshot.base = *shared;
+	auto sg_it = scene_groups.find(canvasName);
+	if (sg_it != scene_groups.end())
+		snapshot.groups = sg_it->second;
+	snapshot.precedence = get_canvas_settings(canvasName).precedence;
+	snapshot.scenes = get_canvas_scene_names(canvasName);
+	if (!with_transitions)
+		return true;
+	struct obs_frontend_source_list transitions = {};
+	obs_frontend_get_transitions(&transitions);
+	for (size_t i = 0; i < transitions.sources.num; i++)
+		snapshot.transitions.push_back(obs_source_get_name(transitions.sources.array[i]));
+	obs_frontend_source_list_free(&transitions);
+	auto ct = canvas_transitions.find(canvasName);
+	if (ct != canvas_transitions.end())
+		snapshot.transitions.insert(snapshot.transitions.end(), ct->second.begin(), ct->second.end());
+	return true;
+}
+
+// a result computed from the snapshot can only be applied while the canvas still has the rules it was taken of
+static bool snapshot_current(const rules_snapshot &snapshot)
+{
+	auto canvas_it = find_canvas_table(snapshot.canvas);
+	if (canvas_it == transition_table.end() || canvas_it->second != snapshot.rules)
+		return false;
+	auto shared = find_shared_rules(snapshot.canvas);
+	if ((shared != nullptr) != snapshot.has_base || (shared && *shared != snapshot.base))
+		return false;
+	if (get_canvas_settings(snapshot.canvas).precedence != snapshot.precedence)
+		return false;
+	auto sg_it = scene_groups.find(snapshot.canvas);
+	if (sg_it == scene_groups.end())
+		return snapshot.groups.groups.empty();
+	return sg_it->second.groups == snapshot.groups.groups && sg_it->second.scene_names == snapshot.groups.scene_names;
+}
+
+static vector<lint_issue> lint_from_snapshot(const rules_snapshot &snapshot)
+{
+	return lint_transition_rules(snapshot.rules, snapshot.has_base ? &snapshot.base : nullptr, &snapshot.groups,
+				     snapshot.precedence, snapshot.scenes, snapshot.transitions);
+}
+
+static obs_data_array_t *names_to_array(const vector<string> &names)
+{
+	obs_data_array_t *array = obs_data_array_create();
+	for (const auto &name : names) {
+		obs_data_t *item = obs_data_create();
+		obs_data_set_string(item, "name", name.c_str());
+		obs_data_array_push_back(array, item);
+		obs_data_release(item);
+	}
+	return array;
+}
+
+static vector<string> names_from_array(obs_data_array_t *array)
+{
+	vector<string> names;
+	const size_t count = obs_data_array_count(array);
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		names.push_back(obs_data_get_string(item, "name"));
+		obs_data_release(item);
+	}
+	return names;
+}
+
+// the changes that restore the rules as they are now, in the order to apply them
+static vector<transition_change> invert_transition_changes(const vector<transition_change> &changes)
+{
+	vector<transition_change> inverse;
+	inverse.reserve(changes.size());
+	for (const auto &change : changes) {
+		const transition_info *existing = nullptr;
+		auto canvas_it = find_canvas_table(change.canvas);
+		if (canvas_it != transition_table.end()) {
+			auto fs_it = canvas_it->second.find(change.from_scene);
+			if (fs_it != canvas_it->second.end()) {
+				auto ts_it = fs_it->second.find(change.to_scene);
+				if (ts_it != fs_it->second.end())
+					existing = &ts_it->second;
+			}
+		}
+		if (existing)
+			inverse.push_back({change.canvas, change.from_scene, change.to_scene, false, *existing});
+		else if (!change.remove)
+			inverse.push_back({change.canvas, change.from_scene, change.to_scene, true, {}});
+	}
+	// a pair changed twice is restored by the inverse of its first change, applied last
+	reverse(inverse.begin(), inverse.end());
+	return inverse;
+}
+
+// every canvas, scene and transition name is stored once, the changes refer to them by index
+static string transition_changes_to_json(const vector<transition_change> &changes)
+{
+	vector<string> names;
+	map<string, long long> name_ids;
+	auto intern = [&](const string &name) {
+		auto it = name_ids.emplace(name, (long long)names.size());
+		if (it.second)
+			names.push_back(name);
+		return it.first->second;
+	};
+	obs_data_array_t *array = obs_data_array_create();
+	for (const auto &change : changes) {
+		obs_data_t *item = obs_data_create();
+		obs_data_set_int(item, "c", intern(change.canvas));
+		obs_data_set_int(item, "f", intern(change.from_scene));
+		obs_data_set_int(item, "t", intern(change.to_scene));
+		// no transition is a removed rule
+		if (!change.remove) {
+			obs_data_set_int(item, "x", intern(change.info.transition));
+			obs_data_set_int(item, "d", change.info.duration);
+		}
+		obs_data_array_push_back(array, item);
+		obs_data_release(item);
+	}
+	obs_data_t *data = obs_data_create();
+	obs_data_array_t *names_array = names_to_array(names);
+	obs_data_set_array(data, "names", names_array);
+	obs_data_array_release(names_array);
+	obs_data_set_array(data, "changes", array);
+	obs_data_array_release(array);
+	string json = obs_data_get_json(data);
+	obs_data_release(data);
+	return json;
+}
+
+static vector<transition_change> transition_changes_from_json(const char *json)
+{
+	vector<transition_change> changes;
+	obs_data_t *data = obs_data_create_from_json(json);
+	if (!data)
+		return changes;
+	obs_data_array_t *names_array = obs_data_get_array(data, "names");
+	const vector<string> names = names_from_array(names_array);
+	obs_data_array_release(names_array);
+	auto name = [&](obs_data_t *item, const char *field, const string **result) {
+		const long long id = obs_data_get_int(item, field);
+		if (id < 0 || (size_t)id >= names.size())
+			return false;
+		*result = &names[id];
+		return true;
+	};
+	obs_data_array_t *array = obs_data_get_array(data, "changes");
+	const size_t count = obs_data_array_count(array);
+	changes.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+		const string *canvas, *from_scene, *to_scene, *transition = nullptr;
+		if (name(item, "c", &canvas) && name(item, "f", &from_scene) && name(item, "t", &to_scene) &&
+		    (!obs_data_has_user_value(item, "x") || name(item, "x", &transition))) {
+			transition_change change = {*canvas, *from_scene, *to_scene, !transition, {}};
+			if (transition)
+				change.info = {*transition, (int)obs_data_get_int(item, "d")};
+			changes.push_back(std::move(change));
+		}
+		obs_data_release(item);
+	}
+	obs_data_array_release(array);
+	obs_data_release(data);
+	return changes;
+}
+
+static void undo_redo_transition_changes(const char *data)
+{
+	apply_transition_changes(transition_changes_from_json(data));
+	if (table_dialog)
+		table_dialog->RefreshTable();
+}
+
+// applies the changes as one step on the frontend undo stack, only the diff is kept for undo and redo
+static void apply_undoable_changes(const char *name, const vector<transition_change> &changes)
+{
+	if (changes.empty())
+		return;
+	const vector<transition_change> inverse = invert_transition_changes(changes);
+	apply_transition_changes(changes);
+	const string undo_data = transition_changes_to_json(inverse);
+	const string redo_data = transition_changes_to_json(changes);
+	obs_frontend_add_undo_redo_action(obs_module_text(name), undo_redo_transition_changes, undo_redo_transition_changes,
+					  undo_data.c_str(), redo_data.c_str(), false);
+}
+
+// the transitions are left out, a replay does not check them
+static string rules_snapshot_to_json(const rules_snapshot &snapshot)
+{
+	obs_data_t *obj = obs_data_create();
+	obs_data_set_int(obj, "precedence", snapshot.precedence);
+	obs_data_array_t *array = rules_to_array(snapshot.rules);
+	obs_data_set_array(obj, "transitions", array);
+	obs_data_array_release(array);
+	if (snapshot.has_base) {
+		array = rules_to_array(snapshot.base);
+		obs_data_set_array(obj, "base", array);
+		obs_data_array_release(array);
+	}
+	array = names_to_array(snapshot.scenes);
+	obs_data_set_array(obj, "scenes", array);
+	obs_data_array_release(array);
+	obs_data_array_t *groups = obs_data_array_create();
+	for (const auto &it : snapshot.groups.groups) {
+		vector<string> members;
+		for (size_t id = 0; id < snapshot.groups.scene_names.size(); id++) {
+			if (scene_in_group(it.second, id))
+				members.push_back(snapshot.groups.scene_names[id]);
+		}
+		obs_data_t *group = obs_data_create();
+		obs_data_set_string(group, "name", it.first.c_str());
+		array = names_to_array(members);
+		obs_data_set_array(group, "scenes", array);
+		obs_data_array_release(array);
+		obs_data_array_push_back(groups, group);
+		obs_data_release(group);
+	}
+	obs_data_set_array(obj, "groups", groups);
+	obs_data_array_release(groups);
+	string json = obs_data_get_json(obj);
+	obs_data_release(obj);
+	return json;
+}
+
+// the canvases using shared rules get their own snapshot, so every canvas in a log resolves on its own
+static void log_rules_snapshot(const string &canvasName)
+{
+	if (is_shared_rules(canvasName)) {
+		for (const auto &it : canvas_settings_map) {
+			if (it.second.shared_rules == canvasName)
+				log_rules_snapshot(it.first);
+		}
+		return;
+	}
+	rules_snapshot snapshot;
+	if (take_rules_snapshot(canvasName, snapshot, false))
+		switch_log_write(SWITCH_LOG_RULES, canvasName, rules_snapshot_to_json(snapshot));
+}
+
+// edits only log what changed, changed shared rules are logged as the base of every canvas using them
+static void log_rule_changes(const vector<transition_change> &changes)
+{
+	map<string, vector<transition_change>> canvases;
+	for (const auto &change : changes)
+		canvases[change.canvas].push_back(change);
+	for (const auto &it : canvases) {
+		const string json = transition_changes_to_json(it.second);
+		if (!is_shared_rules(it.first)) {
+			switch_log_write(SWITCH_LOG_RULE_CHANGES, it.first, json);
+			continue;
+		}
+		for (const auto &cs : canvas_settings_map) {
+			if (cs.second.shared_rules == it.first)
+				switch_log_write(SWITCH_LOG_RULE_CHANGES, cs.first, json, "base");
+		}
+	}
+}
+
+// only the canvases that changed are linted again, the cross canvas check always covers all canvases
+static void run_lint()
+{
+	if (lint_running || lint_dirty.empty())
+		return;
+	auto snapshots = make_shared<vector<rules_snapshot>>();
+	auto dirty = make_shared<set<string>>();
+	for (const auto &canvasName : lint_dirty) {
+		rules_snapshot snapshot;
+		if (take_rules_snapshot(canvasName, snapshot))
+			snapshots->push_back(std::move(snapshot));
+		else
+			lint_results.erase(canvasName);
+		if (is_shared_rules(canvasName))
+			continue;
+		dirty->insert(canvasName);
+		auto it = find_canvas_table(canvasName);
+		if (it == transition_table.end()) {
+			lint_inputs.erase(canvasName);
+			continue;
+		}
+		auto &input = lint_inputs[canvasName];
+		input.rules = make_shared<const transition_rules>(it->second);
+		const bool has_scenes = !snapshots->empty() && snapshots->back().canvas == canvasName;
+		const auto scenes = has_scenes ? snapshots->back().scenes : get_canvas_scene_names(canvasName);
+		input.scenes = make_shared<const set<string>>(scenes.begin(), scenes.end());
+	}
+	lint_dirty.clear();
+	// the worker shares the unchanged copies, only pairs with a dirty canvas are checked again
+	auto inputs = make_shared<const map<string, lint_canvas_input>>(lint_inputs);
+	lint_running = true;
+	const uint64_t generation = lint_generation;
+	thread([snapshots, dirty, inputs, generation] {
+		auto results = make_shared<map<string, vector<lint_issue>>>();
+		for (const auto &snapshot : *snapshots) {
+			profile_scope scope("transition_table_lint", snapshot.canvas.c_str());
+			(*results)[snapshot.canvas] = lint_from_snapshot(snapshot);
+		}
+		auto cross = make_shared<map<pair<string, string>, vector<lint_issue>>>();
+		for (const auto &canvas : *inputs) {
+			for (const auto &other : *inputs) {
+				if (canvas.first == other.first || (!dirty->count(canvas.first) && !dirty->count(other.first)))
+					continue;
+				auto issues = lint_cross_canvas_pair(*canvas.second.rules, *canvas.second.scenes, other.first,
+								     *other.second.rules, *other.second.scenes);
+				if (!issues.empty())
+					(*cross)[{canvas.first, other.first}] = std::move(issues);
+			}
+		}
+		QMetaObject::invokeMethod(
+			lint_context,
+			[results, dirty, cross, generation] {
+				lint_running = false;
+				if (generation == lint_generation) {
+					for (auto &it : *results)
+						lint_results[it.first] = std::move(it.second);
+					for (auto it = cross_canvas_pair_results.begin(); it != cross_canvas_pair_results.end();) {
+						if (dirty->count(it->first.first) || dirty->count(it->first.second))
+							it = cross_canvas_pair_results.erase(it);
+						else
+							++it;
+					}
+					for (auto &it : *cross)
+						cross_canvas_pair_results[it.first] = std::move(it.second);
+					cross_canvas_lint_results.clear();
+					for (const auto &it : cross_canvas_pair_results) {
+						auto &issues = cross_canvas_lint_results[it.first.first];
+						issues.insert(issues.end(), it.second.begin(), it.second.end());
+					}
+					if (table_dialog)
+						table_dialog->RefreshTable();
+				}
+				run_lint();
+			},
+			Qt::QueuedConnection);
+	}).detach();
 }
 
-static bool transition_table_enabled = true;
+static void schedule_lint_all()
+{
+	for (const auto &it : transition_table)
+		schedule_lint(it.first);
+}
 
-static void set_transition_overrides_queued(obs_canvas_t *canvas)
+static vector<lint_issue> get_lint_issues(const string &canvasName)
 {
-	if (obs_canvas_removed(canvas))
-		return;
+	vector<lint_issue> issues;
+	auto it = lint_results.find(canvasName);
+	if (it != lint_results.end())
+		issues = it->second;
+	auto cross_it = cross_canvas_lint_results.find(canvasName);
+	if (cross_it != cross_canvas_lint_results.end())
+		issues.insert(issues.end(), cross_it->second.begin(), cross_it->second.end());
+	return issues;
+}
 
-	string canvasName = obs_canvas_get_name(canvas);
-	auto canvas_it = transition_table.find(canvasName);
-	if (canvas_it == transition_table.end())
-		return;
+static QString lint_issue_text(const lint_issue &issue)
+{
+	string key = string("Lint.") + lint_kind_name(issue.kind);
+	// no rule decides when a rule without transition stops the lookup first
+	if (issue.kind == LINT_SHADOWED && issue.detail.empty())
+		key += "_blocked";
+	return QString::fromUtf8(obs_module_text(key.c_str())).arg(QString::fromUtf8(issue.detail.c_str()));
+}
 
-	obs_source_t *scene = obs_canvas_get_channel(canvas, 0);
-	if (scene && obs_source_get_type(scene) == OBS_SOURCE_TYPE_TRANSITION) {
-		obs_source_release(scene);
-		scene = obs_transition_get_active_source(scene);
-	}
-	string fromScene;
-	if (scene) {
-		fromScene = obs_source_get_name(scene);
-		obs_source_release(scene);
+static transition_rules minimize_from_snapshot(const rules_snapshot &snapshot, minimize_result &result,
+					       const function<void(size_t done, size_t count)> &progress = nullptr)
+{
+	return minimize_transition_rules(snapshot.rules, snapshot.has_base ? &snapshot.base : nullptr, &snapshot.groups,
+					 snapshot.precedence, snapshot.scenes, result, progress);
+}
+
+static void apply_minimized_rules(const string &canvasName, const transition_rules &minimized)
+{
+	if (!on_ui_thread(__func__))
+		return;
+	vector<transition_rule> rules;
+	for (const auto &from : minimized) {
+		for (const auto &to : from.second)
+			rules.push_back({canvasName, from.first, to.first, to.second});
 	}
+	vector<transition_change> changes;
+	diff_canvas_rules(canvasName, rules.data(), rules.data() + rules.size(), IMPORT_MODE_REPLACE, changes);
+	apply_transition_changes(changes);
+}
 
-	auto fs_it = fromScene.empty() ? canvas_it->second.end() : canvas_it->second.find(fromScene);
-	auto as_it = canvas_it->second.find("Any");
+static void log_minimize_result(const string &canvasName, const minimize_result &result)
+{
+	blog(LOG_INFO,
+	     "[Transition Table] minimize '%s': %zu -> %zu rules, %zu removed, %zu folded into Any, memory %zu -> %zu bytes, save size %zu -> %zu bytes",
+	     canvasName.c_str(), result.rules_before, result.rules_after, result.removed, result.folded,
+	     result.memory_before, result.memory_after, result.save_size_before, result.save_size_after);
+}
 
-	vector<obs_source_t *> scenes;
-	obs_canvas_enum_scenes(
-		canvas,
-		[](void *param, obs_source_t *scene) {
-			auto scenes = (vector<obs_source_t *> *)param;
-			scenes->push_back(obs_source_get_ref(scene));
-			return true;
-		},
-		&scenes);
+// editors often save by writing a new file and renaming it over the old one, the file can be missing for a moment
+static const int linked_file_retries = 5;
+static const int linked_file_retry_ms = 200;
 
-	for (size_t i = 0; i < scenes.size(); i++) {
-		string toScene = obs_source_get_name(scenes[i]);
-		string transition;
-		auto duration = 0;
-		if (fs_it != canvas_it->second.end()) {
-			auto to_it = fs_it->second.find(toScene);
-			if (to_it == fs_it->second.end()) {
-				to_it = fs_it->second.find("Any");
-			}
-			if (to_it != fs_it->second.end()) {
-				transition = to_it->second.transition;
-				duration = to_it->second.duration;
-			}
-		}
-		if (transition.empty() && as_it != canvas_it->second.end()) {
-			auto to_it = as_it->second.find(toScene);
-			if (to_it == as_it->second.end()) {
-				to_it = as_it->second.find("Any");
-			}
-			if (to_it != as_it->second.end()) {
-				transition = to_it->second.transition;
-				duration = to_it->second.duration;
+static void reload_linked_file(const string &canvasName, int attempt = 0)
+{
+	auto it = linked_files.find(canvasName);
+	if (it == linked_files.end())
+		return;
+	const string file = it->second;
+	const QString path = QString::fromUtf8(file.c_str());
+	// replacing the file removes it from the watcher, it is only watched again once it exists
+	if (!linked_files_watcher->files().contains(path))
+		linked_files_watcher->addPath(path);
+	thread([canvasName, file, attempt] {
+		obs_data_t *data = obs_data_create_from_json_file(file.c_str());
+		obs_data_array_t *transitions = data ? obs_data_get_array(data, "transitions") : nullptr;
+		if (!transitions) {
+			obs_data_release(data);
+			if (attempt >= linked_file_retries) {
+				blog(LOG_WARNING, "[Transition Table] failed to load linked file %s", file.c_str());
+				return;
 			}
+			QMetaObject::invokeMethod(
+				linked_files_watcher,
+				[canvasName, file, attempt] {
+					QTimer::singleShot(linked_file_retry_ms, linked_files_watcher, [canvasName, file, attempt] {
+						auto it = linked_files.find(canvasName);
+						if (it != linked_files.end() && it->second == file)
+							reload_linked_file(canvasName, attempt + 1);
+					});
+				},
+				Qt::QueuedConnection);
+			return;
 		}
-		obs_data_t *data = obs_source_get_private_settings(scenes[i]);
-		if (transition.empty()) {
-			obs_data_erase(data, "transition");
-		} else {
-			obs_data_set_string(data, "transition", transition.c_str());
-			obs_data_set_int(data, "transition_duration", duration);
-		}
+		obs_data_array_release(transitions);
+		auto rules = make_shared<vector<transition_rule>>();
+		read_transition_rules(data, canvasName.c_str(), *rules);
 		obs_data_release(data);
-		obs_source_release(scenes[i]);
+		const size_t read = rules->size();
+		rules->erase(remove_if(rules->begin(), rules->end(),
+				       [&canvasName](const transition_rule &rule) { return rule.canvas != canvasName; }),
+			     rules->end());
+		// replacing with nothing would wipe the canvas, a half written or wrong file is more likely than that intent
+		if (rules->empty()) {
+			blog(LOG_WARNING, "[Transition Table] ignoring linked file %s, none of its %d rules are for canvas '%s'",
+			     file.c_str(), (int)read, canvasName.c_str());
+			return;
+		}
+		QMetaObject::invokeMethod(
+			linked_files_watcher,
+			[canvasName, file, path = QString::fromUtf8(file.c_str()), rules] {
+				auto it = linked_files.find(canvasName);
+				if (it == linked_files.end() || it->second != file)
+					return;
+				if (!linked_files_watcher->files().contains(path))
+					linked_files_watcher->addPath(path);
+				vector<transition_change> changes;
+				diff_canvas_rules(canvasName, rules->data(), rules->data() + rules->size(), IMPORT_MODE_REPLACE,
+						  changes);
+				if (changes.empty())
+					return;
+				blog(LOG_INFO, "[Transition Table] applying %d changes from %s", (int)changes.size(), file.c_str());
+				apply_transition_changes(changes);
+			},
+			Qt::QueuedConnection);
+	}).detach();
+}
+
+static void link_file(const string &canvasName, const string &file)
+{
+	if (!linked_files_watcher) {
+		linked_files_watcher = new QFileSystemWatcher;
+		QObject::connect(linked_files_watcher, &QFileSystemWatcher::fileChanged, [](const QString &path) {
+			const string file = path.toUtf8().constData();
+			for (const auto &it : linked_files) {
+				if (it.second == file)
+					reload_linked_file(it.first);
+			}
+		});
 	}
+	unlink_file(canvasName);
+	linked_files[canvasName] = file;
+	reload_linked_file(canvasName);
 }
 
-static void set_transition_overrides(obs_canvas_t *canvas)
+// counts the rule that resolves the started transition, when it is the transition that started
+static void record_rule_usage(const string &canvasName, const string &transitionName, const string &fromScene,
+			      const string &toScene)
 {
-	if (obs_canvas_removed(canvas))
+	auto canvas_table = find_resolve_table(canvasName);
+	if (!canvas_table)
 		return;
-	obs_queue_task(
-		obs_in_task_thread(OBS_TASK_GRAPHICS) ? OBS_TASK_UI : OBS_TASK_GRAPHICS,
-		[](void *param) { set_transition_overrides_queued((obs_canvas_t *)param); }, canvas, false);
+	auto &dt = get_decision_table(canvasName, *canvas_table);
+	const int32_t rule = dt.resolve_rule(fromScene, toScene);
+	if (rule < 0 || dt.rule_info(rule).transition != transitionName)
+		return;
+	const string key = dt.rule_is_base(rule) ? get_canvas_settings(canvasName).shared_rules : canvasName;
+	auto &usage = rule_usage_table[key][{dt.rule_from_key(rule), dt.rule_to_key(rule)}];
+	usage.hits++;
+	usage.last_used = (int64_t)time(nullptr);
+}
+
+static string transition_source_name(obs_source_t *transition, enum obs_transition_target target)
+{
+	string name;
+	obs_source_t *source = obs_transition_get_source(transition, target);
+	if (source) {
+		name = obs_source_get_name(source);
+		obs_source_release(source);
+	}
+	return name;
 }
 
 static void transition_start(void *data, calldata_t *call_data)
 {
-	UNUSED_PARAMETER(call_data);
 	obs_canvas_t *canvas = (obs_canvas_t *)data;
+	profile_scope scope("transition_table_transition_start", obs_canvas_get_name(canvas));
+	if (switch_log_recording())
+		switch_log_write(SWITCH_LOG_TRANSITION_START, obs_canvas_get_name(canvas));
 
-	if (transition_table_enabled)
-		set_transition_overrides(canvas);
+	obs_source_t *transition = (obs_source_t *)calldata_ptr(call_data, "source");
+	string transitionName = transition ? obs_source_get_name(transition) : "";
+	string fromScene = transition ? transition_source_name(transition, OBS_TRANSITION_SOURCE_A) : "";
+	string toScene = transition ? transition_source_name(transition, OBS_TRANSITION_SOURCE_B) : "";
+
+	// transitions can start on the graphics thread
+	canvas = obs_canvas_get_ref(canvas);
+	if (!canvas)
+		return;
+	queue_on_ui_thread([canvas, transitionName, fromScene, toScene] {
+		const string canvasName = obs_canvas_get_name(canvas);
+		if (canvas_enabled(canvasName)) {
+			if (!toScene.empty())
+				record_rule_usage(canvasName, transitionName, fromScene, toScene);
+			// already on the UI thread, the pass needs no second trip through the task queue
+			if (!override_pass_deferred(canvas))
+				set_transition_overrides_queued(canvas);
+		}
+		obs_canvas_release(canvas);
+	});
 }
 
-static void channel_change(void *data, calldata_t *call_data)
+static void program_source_changed(obs_canvas_t *canvas, obs_source_t *source, obs_source_t *prev_source)
 {
-	UNUSED_PARAMETER(data);
-	if (calldata_int(call_data, "channel") != 0)
-		return;
-	obs_canvas_t *canvas = (obs_canvas_t *)calldata_ptr(call_data, "canvas");
-	obs_source_t *source = (obs_source_t *)calldata_ptr(call_data, "source");
-	obs_source_t *prev_source = (obs_source_t *)calldata_ptr(call_data, "prev_source");
 	string canvasName = obs_canvas_get_name(canvas);
+	profile_scope scope("transition_table_channel_change", canvasName.c_str());
 	if (prev_source && obs_source_get_type(prev_source) == OBS_SOURCE_TYPE_TRANSITION) {
 		auto sh = obs_source_get_signal_handler(prev_source);
 		signal_handler_disconnect(sh, "transition_start", transition_start, canvas);
@@ -212,10 +1717,85 @@ static void channel_change(void *data, calldata_t *call_data)
 		auto sh = obs_source_get_signal_handler(source);
 		signal_handler_connect(sh, "transition_start", transition_start, canvas);
 	}
-	if (source && transition_table_enabled)
+	if (source && switch_log_recording())
+		switch_log_write(SWITCH_LOG_CHANNEL_CHANGE, canvasName, obs_source_get_name(source));
+	if (source && canvas_enabled(canvasName))
 		set_transition_overrides(canvas);
 }
 
+static void channel_change(void *data, calldata_t *call_data)
+{
+	UNUSED_PARAMETER(data);
+	if (calldata_int(call_data, "channel") != 0)
+		return;
+	obs_canvas_t *canvas = (obs_canvas_t *)calldata_ptr(call_data, "canvas");
+	obs_source_t *source = (obs_source_t *)calldata_ptr(call_data, "source");
+	obs_source_t *prev_source = (obs_source_t *)calldata_ptr(call_data, "prev_source");
+	if (obs_in_task_thread(OBS_TASK_UI)) {
+		program_source_changed(canvas, source, prev_source);
+		return;
+	}
+	canvas = obs_canvas_get_ref(canvas);
+	if (!canvas)
+		return;
+	source = obs_source_get_ref(source);
+	prev_source = obs_source_get_ref(prev_source);
+	queue_on_ui_thread([canvas, source, prev_source] {
+		program_source_changed(canvas, source, prev_source);
+		obs_source_release(prev_source);
+		obs_source_release(source);
+		obs_canvas_release(canvas);
+	});
+}
+
+static void rename_scene(const string &canvasName, const string &prev_name, const string &new_name)
+{
+	profile_scope scope("transition_table_source_rename", canvasName.c_str());
+	if (switch_log_recording())
+		switch_log_write(SWITCH_LOG_RENAME, canvasName, prev_name, new_name);
+	auto sg_it = scene_groups.find(canvasName);
+	if (sg_it != scene_groups.end() && rename_scene_in_groups(sg_it->second, prev_name, new_name))
+		canvas_rules_context_changed(canvasName);
+	auto profiles_it = canvas_profiles.find(canvasName);
+	if (profiles_it != canvas_profiles.end()) {
+		for (auto &profile : profiles_it->second) {
+			rename_scene_in_rules(profile.second.rules, prev_name, new_name);
+			profile.second.table.reset();
+		}
+	}
+	// shared rules are renamed once no canvas using them has a scene with the old name left
+	auto cs_it = canvas_settings_map.find(canvasName);
+	if (cs_it != canvas_settings_map.end() && !cs_it->second.shared_rules.empty()) {
+		const string &key = cs_it->second.shared_rules;
+		auto shared_it = find_canvas_table(key);
+		if (shared_it != transition_table.end()) {
+			string still_used;
+			for (const auto &cs : canvas_settings_map) {
+				if (cs.second.shared_rules == key && cs.first != canvasName &&
+				    canvas_has_scene(cs.first, prev_name)) {
+					still_used = cs.first;
+					break;
+				}
+			}
+			if (still_used.empty()) {
+				rename_scene_in_rules(shared_it->second, prev_name, new_name);
+				rename_scene_in_usage(key, prev_name, new_name);
+				transition_table_changed(key);
+			} else {
+				blog(LOG_WARNING,
+				     "[Transition Table] shared rules '%s' keep '%s' renamed to '%s' on canvas '%s', canvas '%s' still has it",
+				     key.c_str(), prev_name.c_str(), new_name.c_str(), canvasName.c_str(), still_used.c_str());
+			}
+		}
+	}
+	auto it = find_canvas_table(canvasName);
+	if (it == transition_table.end())
+		return;
+	rename_scene_in_rules(it->second, prev_name, new_name);
+	rename_scene_in_usage(canvasName, prev_name, new_name);
+	transition_table_changed(canvasName);
+}
+
 static void source_rename(void *data, calldata_t *call_data)
 {
 	UNUSED_PARAMETER(data);
@@ -227,25 +1807,83 @@ static void source_rename(void *data, calldata_t *call_data)
 		return;
 	string canvasName = obs_canvas_get_name(c);
 	obs_canvas_release(c);
-	auto it = transition_table.find(canvasName);
-	if (it == transition_table.end())
-		return;
-	auto it2 = it->second.find(prev_name);
-	if (it2 != it->second.end()) {
-		it->second[new_name] = it2->second;
-		it->second.erase(it2);
-	}
-	for (const auto &it2 : it->second) {
-		auto it3 = it2.second.find(prev_name);
-		if (it3 != it2.second.end()) {
-			it->second[it2.first][new_name] = it3->second;
-			it->second[it2.first].erase(it3);
-		}
-	}
+	// obs-websocket and scripts rename from their own threads
+	queue_on_ui_thread([canvasName, prev_name, new_name] { rename_scene(canvasName, prev_name, new_name); });
+}
+
+// only the scenes of this canvas are touched
+static bool set_canvas_enabled(const string &canvasName, bool enabled)
+{
+	if (is_shared_rules(canvasName))
+		return false;
+	auto cs = edit_canvas_settings(canvasName);
+	if (!cs || cs->enabled == enabled)
+		return false;
+	cs->enabled = enabled;
+	blog(LOG_INFO, "[Transition Table] %s canvas '%s'", enabled ? "enabled" : "disabled", canvasName.c_str());
+	obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+	if (!c)
+		return true;
+	if (enabled)
+		set_transition_overrides(c);
+	else
+		clear_transition_overrides(c);
+	obs_canvas_release(c);
+	return true;
+}
+
+static bool canvas_enable_hotkey(void *data, obs_hotkey_pair_id id, obs_hotkey_t *hotkey, bool pressed)
+{
+	UNUSED_PARAMETER(id);
+	UNUSED_PARAMETER(hotkey);
+	if (!pressed)
+		return false;
+	queue_on_ui_thread([canvasName = *(const string *)data] { set_canvas_enabled(canvasName, true); });
+	return true;
+}
+
+static bool canvas_disable_hotkey(void *data, obs_hotkey_pair_id id, obs_hotkey_t *hotkey, bool pressed)
+{
+	UNUSED_PARAMETER(id);
+	UNUSED_PARAMETER(hotkey);
+	if (!pressed)
+		return false;
+	queue_on_ui_thread([canvasName = *(const string *)data] { set_canvas_enabled(canvasName, false); });
+	return true;
+}
+
+static canvas_settings &register_canvas_hotkeys(const string &canvasName)
+{
+	auto it = canvas_settings_map.try_emplace(canvasName).first;
+	auto &cs = it->second;
+	if (cs.hotkey != OBS_INVALID_HOTKEY_PAIR_ID)
+		return cs;
+	// the map key outlives the hotkeys, they are unregistered before the map is cleared
+	void *data = (void *)&it->first;
+	const string suffix = " (" + canvasName + ")";
+	const string enable_name = "transition-table.enable." + canvasName;
+	const string disable_name = "transition-table.disable." + canvasName;
+	const string enable_description = obs_module_text("TransitionTable.Enable") + suffix;
+	const string disable_description = obs_module_text("TransitionTable.Disable") + suffix;
+	cs.hotkey = obs_hotkey_pair_register_frontend(enable_name.c_str(), enable_description.c_str(), disable_name.c_str(),
+						      disable_description.c_str(), canvas_enable_hotkey, canvas_disable_hotkey,
+						      data, data);
+	return cs;
+}
+
+static void connect_canvas_signals(obs_canvas_t *canvas)
+{
+	auto sh = obs_canvas_get_signal_handler(canvas);
+	signal_handler_disconnect(sh, "source_rename", source_rename, nullptr);
+	signal_handler_connect(sh, "source_rename", source_rename, nullptr);
+	signal_handler_disconnect(sh, "channel_change", channel_change, nullptr);
+	signal_handler_connect(sh, "channel_change", channel_change, nullptr);
 }
 
 static void frontend_save_load(obs_data_t *save_data, bool saving, void *)
 {
+	profile_scope scope(saving ? "transition_table_save" : "transition_table_load");
+	stats_timer timer(saving ? stats.save : stats.load);
 	if (saving) {
 		obs_data_t *obj = obs_data_create();
 		obs_data_array_t *transitions = obs_data_array_create();
@@ -264,7 +1902,128 @@ static void frontend_save_load(obs_data_t *save_data, bool saving, void *)
 				}
 			}
 		}
+		for (const auto &it : pending_transitions) {
+			const size_t count = obs_data_array_count(it.second);
+			for (size_t i = 0; i < count; i++) {
+				obs_data_t *transition = obs_data_array_item(it.second, i);
+				obs_data_array_push_back(transitions, transition);
+				obs_data_release(transition);
+			}
+		}
 		obs_data_set_array(obj, "transitions", transitions);
+		obs_data_array_t *files = obs_data_array_create();
+		for (const auto &it : linked_files) {
+			obs_data_t *file = obs_data_create();
+			obs_data_set_string(file, "canvas", it.first.c_str());
+			obs_data_set_string(file, "file", it.second.c_str());
+			obs_data_array_push_back(files, file);
+			obs_data_release(file);
+		}
+		obs_data_set_array(obj, "linked_files", files);
+		obs_data_array_release(files);
+		obs_data_array_t *groups = obs_data_array_create();
+		for (const auto &it : scene_groups) {
+			for (const auto &it2 : it.second.groups) {
+				obs_data_t *group = obs_data_create();
+				obs_data_set_string(group, "canvas", it.first.c_str());
+				obs_data_set_string(group, "name", it2.first.c_str() + 6);
+				obs_data_array_t *scenes = obs_data_array_create();
+				for (const auto &sceneName : get_group_scenes(it.first, it2.first)) {
+					obs_data_t *scene = obs_data_create();
+					obs_data_set_string(scene, "name", sceneName.c_str());
+					obs_data_array_push_back(scenes, scene);
+					obs_data_release(scene);
+				}
+				obs_data_set_array(group, "scenes", scenes);
+				obs_data_array_release(scenes);
+				obs_data_array_push_back(groups, group);
+				obs_data_release(group);
+			}
+		}
+		obs_data_set_array(obj, "groups", groups);
+		obs_data_array_release(groups);
+		obs_data_array_t *settings = obs_data_array_create();
+		for (const auto &it : canvas_settings_map) {
+			obs_data_t *setting = obs_data_create();
+			obs_data_set_string(setting, "canvas", it.first.c_str());
+			obs_data_set_int(setting, "precedence", it.second.precedence);
+			obs_data_set_string(setting, "profile", it.second.profile.c_str());
+			obs_data_set_bool(setting, "enabled", it.second.enabled);
+			obs_data_set_string(setting, "shared_rules", it.second.shared_rules.c_str());
+			obs_data_set_bool(setting, "on_demand", it.second.on_demand);
+			obs_data_array_t *eh = nullptr;
+			obs_data_array_t *dh = nullptr;
+			obs_hotkey_pair_save(it.second.hotkey, &eh, &dh);
+			if (eh) {
+				obs_data_set_array(setting, "enable_hotkey", eh);
+				obs_data_array_release(eh);
+			}
+			if (dh) {
+				obs_data_set_array(setting, "disable_hotkey", dh);
+				obs_data_array_release(dh);
+			}
+			obs_data_array_push_back(settings, setting);
+			obs_data_release(setting);
+		}
+		obs_data_set_array(obj, "canvas_settings", settings);
+		obs_data_array_release(settings);
+		obs_data_array_t *profiles = obs_data_array_create();
+		for (const auto &it : canvas_profiles) {
+			for (const auto &it2 : it.second) {
+				obs_data_t *profile = obs_data_create();
+				obs_data_set_string(profile, "canvas", it.first.c_str());
+				obs_data_set_string(profile, "name", it2.first.c_str());
+				obs_data_array_t *profile_transitions = obs_data_array_create();
+				for (const auto &from : it2.second.rules) {
+					for (const auto &to : from.second) {
+						obs_data_t *transition = obs_data_create();
+						obs_data_set_string(transition, "from_scene", from.first.c_str());
+						obs_data_set_string(transition, "to_scene", to.first.c_str());
+						obs_data_set_string(transition, "transition", to.second.transition.c_str());
+						obs_data_set_int(transition, "duration", to.second.duration);
+						obs_data_array_push_back(profile_transitions, transition);
+						obs_data_release(transition);
+					}
+				}
+				obs_data_set_array(profile, "transitions", profile_transitions);
+				obs_data_array_release(profile_transitions);
+				obs_data_array_t *hotkey = obs_hotkey_save(it2.second.hotkey);
+				obs_data_set_array(profile, "hotkey", hotkey);
+				obs_data_array_release(hotkey);
+				obs_data_array_push_back(profiles, profile);
+				obs_data_release(profile);
+			}
+		}
+		obs_data_set_array(obj, "profiles", profiles);
+		obs_data_array_release(profiles);
+		obs_data_set_bool(obj, "studio_mode_targeted", studio_mode_targeted);
+		obs_data_set_bool(obj, "persist_rule_usage", persist_rule_usage);
+		if (persist_rule_usage) {
+			obs_data_array_t *usages = obs_data_array_create();
+			for (const auto &it : rule_usage_table) {
+				// rules that were deleted are dropped, rules that are not loaded yet are kept
+				auto table_it = transition_table.find(it.first);
+				const bool loaded = table_it != transition_table.end() && !pending_transitions.count(it.first);
+				for (const auto &it2 : it.second) {
+					if (loaded) {
+						auto from_it = table_it->second.find(it2.first.first);
+						if (from_it == table_it->second.end() || !from_it->second.count(it2.first.second))
+							continue;
+					}
+					obs_data_t *usage = obs_data_create();
+					obs_data_set_string(usage, "canvas", it.first.c_str());
+					obs_data_set_string(usage, "from_scene", it2.first.first.c_str());
+					obs_data_set_string(usage, "to_scene", it2.first.second.c_str());
+					obs_data_set_int(usage, "hits", (long long)it2.second.hits);
+					obs_data_set_int(usage, "last_used", it2.second.last_used);
+					obs_data_array_push_back(usages, usage);
+					obs_data_release(usage);
+				}
+			}
+			obs_data_set_array(obj, "rule_usage", usages);
+			obs_data_array_release(usages);
+		}
+		obs_data_set_int(obj, "stats_log_interval", stats_log_interval);
 		if (transition_table_width > 500 && transition_table_height > 300) {
 			obs_data_set_int(obj, "dialog_width", transition_table_width);
 			obs_data_set_int(obj, "dialog_height", transition_table_height);
@@ -284,8 +2043,7 @@ static void frontend_save_load(obs_data_t *save_data, bool saving, void *)
 		obs_data_array_release(transitions);
 		obs_data_release(obj);
 	} else {
-		transition_table.clear();
-		canvas_transitions.clear();
+		clear_transitions();
 		obs_canvas_t *mc = obs_get_main_canvas();
 		string canvasName = obs_canvas_get_name(mc);
 		obs_canvas_release(mc);
@@ -293,12 +2051,93 @@ static void frontend_save_load(obs_data_t *save_data, bool saving, void *)
 		if (obj) {
 			transition_table_width = obs_data_get_int(obj, "dialog_width");
 			transition_table_height = obs_data_get_int(obj, "dialog_height");
+			set_studio_mode_targeted(obs_data_get_bool(obj, "studio_mode_targeted"));
+			persist_rule_usage = obs_data_get_bool(obj, "persist_rule_usage");
+			obs_data_array_t *usages = obs_data_get_array(obj, "rule_usage");
+			const size_t usage_count = obs_data_array_count(usages);
+			for (size_t i = 0; i < usage_count; i++) {
+				obs_data_t *item = obs_data_array_item(usages, i);
+				auto &usage = rule_usage_table[obs_data_get_string(item, "canvas")]
+							      [{obs_data_get_string(item, "from_scene"),
+								obs_data_get_string(item, "to_scene")}];
+				usage.hits = (uint64_t)obs_data_get_int(item, "hits");
+				usage.last_used = obs_data_get_int(item, "last_used");
+				obs_data_release(item);
+			}
+			obs_data_array_release(usages);
+			set_stats_log_interval((int)obs_data_get_int(obj, "stats_log_interval"));
 			obs_data_array_t *eh = obs_data_get_array(obj, "enable_hotkey");
 			obs_data_array_t *dh = obs_data_get_array(obj, "disable_hotkey");
 			obs_hotkey_pair_load(transition_table_hotkey, eh, dh);
 			obs_data_array_release(eh);
 			obs_data_array_release(dh);
-			load_transitions(obj, canvasName.c_str());
+			load_transitions_pending(obj, canvasName.c_str());
+			obs_data_array_t *settings = obs_data_get_array(obj, "canvas_settings");
+			const size_t settings_count = obs_data_array_count(settings);
+			for (size_t i = 0; i < settings_count; i++) {
+				obs_data_t *setting = obs_data_array_item(settings, i);
+				obs_data_set_default_bool(setting, "enabled", true);
+				auto &cs = register_canvas_hotkeys(obs_data_get_string(setting, "canvas"));
+				cs.precedence = (enum rule_precedence)obs_data_get_int(setting, "precedence");
+				cs.profile = obs_data_get_string(setting, "profile");
+				cs.enabled = obs_data_get_bool(setting, "enabled");
+				cs.shared_rules = obs_data_get_string(setting, "shared_rules");
+				cs.on_demand = obs_data_get_bool(setting, "on_demand");
+				obs_data_array_t *ceh = obs_data_get_array(setting, "enable_hotkey");
+				obs_data_array_t *cdh = obs_data_get_array(setting, "disable_hotkey");
+				obs_hotkey_pair_load(cs.hotkey, ceh, cdh);
+				obs_data_array_release(ceh);
+				obs_data_array_release(cdh);
+				obs_data_release(setting);
+			}
+			obs_data_array_release(settings);
+			obs_data_array_t *profiles = obs_data_get_array(obj, "profiles");
+			const size_t profile_count = obs_data_array_count(profiles);
+			for (size_t i = 0; i < profile_count; i++) {
+				obs_data_t *profile_data = obs_data_array_item(profiles, i);
+				auto &profile = add_profile(obs_data_get_string(profile_data, "canvas"),
+							    obs_data_get_string(profile_data, "name"));
+				vector<transition_rule> rules;
+				read_transition_rules(profile_data, profile.canvas.c_str(), rules);
+				for (const auto &rule : rules)
+					profile.rules[rule.from_scene][rule.to_scene] = rule.info;
+				obs_data_array_t *hotkey = obs_data_get_array(profile_data, "hotkey");
+				obs_hotkey_load(profile.hotkey, hotkey);
+				obs_data_array_release(hotkey);
+				obs_data_release(profile_data);
+			}
+			obs_data_array_release(profiles);
+			obs_data_array_t *groups = obs_data_get_array(obj, "groups");
+			const size_t group_count = obs_data_array_count(groups);
+			for (size_t i = 0; i < group_count; i++) {
+				obs_data_t *group = obs_data_array_item(groups, i);
+				string groupCanvas = obs_data_get_string(group, "canvas");
+				if (groupCanvas.empty())
+					groupCanvas = canvasName;
+				obs_data_array_t *scenes = obs_data_get_array(group, "scenes");
+				vector<string> sceneNames;
+				const size_t scene_count = obs_data_array_count(scenes);
+				for (size_t j = 0; j < scene_count; j++) {
+					obs_data_t *scene = obs_data_array_item(scenes, j);
+					sceneNames.push_back(obs_data_get_string(scene, "name"));
+					obs_data_release(scene);
+				}
+				obs_data_array_release(scenes);
+				set_group_scenes(groupCanvas, string("group:") + obs_data_get_string(group, "name"), sceneNames);
+				obs_data_release(group);
+			}
+			obs_data_array_release(groups);
+			obs_data_array_t *files = obs_data_get_array(obj, "linked_files");
+			const size_t count = obs_data_array_count(files);
+			for (size_t i = 0; i < count; i++) {
+				obs_data_t *file = obs_data_array_item(files, i);
+				string linkedCanvas = obs_data_get_string(file, "canvas");
+				string linkedFile = obs_data_get_string(file, "file");
+				if (!linkedCanvas.empty() && !linkedFile.empty())
+					link_file(linkedCanvas, linkedFile);
+				obs_data_release(file);
+			}
+			obs_data_array_release(files);
 			obs_data_release(obj);
 		} else {
 			obj = obs_data_get_obj(save_data, "obs-transition-matrix");
@@ -326,62 +2165,81 @@ static void frontend_save_load(obs_data_t *save_data, bool saving, void *)
 		obs_enum_canvases(
 			[](void *param, obs_canvas_t *canvas) {
 				UNUSED_PARAMETER(param);
-				auto sh = obs_canvas_get_signal_handler(canvas);
-				signal_handler_disconnect(sh, "source_rename", source_rename, nullptr);
-				signal_handler_connect(sh, "source_rename", source_rename, nullptr);
-				signal_handler_disconnect(sh, "channel_change", channel_change, nullptr);
-				signal_handler_connect(sh, "channel_change", channel_change, nullptr);
+				register_canvas_hotkeys(obs_canvas_get_name(canvas));
+				connect_canvas_signals(canvas);
 				return true;
 			},
 			nullptr);
 	}
 }
 
-static void clear_transition_overrides(obs_canvas_t *canvas)
+static void canvas_create(void *data, calldata_t *call_data)
 {
-	obs_canvas_enum_scenes(
-		canvas,
-		[](void *param, obs_source_t *scene) {
-			UNUSED_PARAMETER(param);
-			obs_data_t *data = obs_source_get_private_settings(scene);
-			obs_data_erase(data, "transition");
-			obs_data_release(data);
-			return true;
-		},
-		nullptr);
+	UNUSED_PARAMETER(data);
+	obs_canvas_t *canvas = (obs_canvas_t *)calldata_ptr(call_data, "canvas");
+	if (!canvas)
+		return;
+	connect_canvas_signals(canvas);
+	// the settings are only inserted on the UI thread
+	queue_on_ui_thread([canvasName = string(obs_canvas_get_name(canvas))] {
+		register_canvas_hotkeys(canvasName);
+		materialize_transitions(canvasName);
+	});
 }
 
 static void frontend_event(enum obs_frontend_event event, void *)
 {
 	if (event == OBS_FRONTEND_EVENT_SCENE_CHANGED) {
-		if (transition_table_enabled) {
-			obs_canvas_t *mc = obs_get_main_canvas();
+		obs_canvas_t *mc = obs_get_main_canvas();
+		if (switch_log_recording())
+			switch_log_write(SWITCH_LOG_SCENE_CHANGED, obs_canvas_get_name(mc), get_current_scene_name(mc));
+		if (canvas_enabled(obs_canvas_get_name(mc)))
 			set_transition_overrides(mc);
-			obs_canvas_release(mc);
-		}
+		obs_canvas_release(mc);
+	} else if (event == OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED) {
+		if (studio_mode_targeted && studio_mode_active)
+			set_preview_override();
+	} else if (event == OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED) {
+		studio_mode_active = true;
+		if (studio_mode_targeted)
+			set_preview_override();
+	} else if (event == OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED) {
+		studio_mode_active = false;
+		set_studio_mode_targeted(studio_mode_targeted);
+	} else if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
+		studio_mode_active = obs_frontend_preview_program_mode_active();
+	} else if (event == OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED || event == OBS_FRONTEND_EVENT_TRANSITION_LIST_CHANGED) {
+		schedule_lint_all();
 	} else if (event == OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP || event == OBS_FRONTEND_EVENT_EXIT) {
-		transition_table.clear();
-		canvas_transitions.clear();
+		clear_transitions();
 	}
 }
 
+// the global hotkeys switch every canvas
+static bool set_all_canvases_enabled(bool enabled)
+{
+	bool changed = false;
+	auto param = make_pair(enabled, &changed);
+	obs_enum_canvases(
+		[](void *param, obs_canvas_t *canvas) {
+			auto p = (pair<bool, bool *> *)param;
+			if (set_canvas_enabled(obs_canvas_get_name(canvas), p->first))
+				*p->second = true;
+			return true;
+		},
+		&param);
+	return changed;
+}
+
 bool enable_hotkey(void *data, obs_hotkey_pair_id id, obs_hotkey_t *hotkey, bool pressed)
 {
 	UNUSED_PARAMETER(data);
 	UNUSED_PARAMETER(id);
 	UNUSED_PARAMETER(hotkey);
-	if (!transition_table_enabled && pressed) {
-		transition_table_enabled = true;
-		obs_enum_canvases(
-			[](void *param, obs_canvas_t *canvas) {
-				UNUSED_PARAMETER(param);
-				set_transition_overrides(canvas);
-				return true;
-			},
-			nullptr);
-		return true;
-	}
-	return false;
+	if (!pressed)
+		return false;
+	queue_on_ui_thread([] { set_all_canvases_enabled(true); });
+	return true;
 }
 
 bool disable_hotkey(void *data, obs_hotkey_pair_id id, obs_hotkey_t *hotkey, bool pressed)
@@ -389,49 +2247,87 @@ bool disable_hotkey(void *data, obs_hotkey_pair_id id, obs_hotkey_t *hotkey, boo
 	UNUSED_PARAMETER(data);
 	UNUSED_PARAMETER(id);
 	UNUSED_PARAMETER(hotkey);
-	if (transition_table_enabled && pressed) {
-		transition_table_enabled = false;
-		obs_enum_canvases(
-			[](void *param, obs_canvas_t *canvas) {
-				UNUSED_PARAMETER(param);
-				clear_transition_overrides(canvas);
-				return true;
-			},
-			nullptr);
-		return true;
-	}
-	return false;
+	if (!pressed)
+		return false;
+	queue_on_ui_thread([] { set_all_canvases_enabled(false); });
+	return true;
 }
 
 static void get_transition(std::string canvas_name, std::string from_scene, std::string to_scene, std::string &transition,
 			   int &duration)
 {
-	auto canvas_it = transition_table.find(canvas_name);
-	if (canvas_it == transition_table.end())
+	auto canvas_table = find_resolve_table(canvas_name);
+	if (!canvas_table)
 		return;
 
-	auto fs_it = canvas_it->second.find(from_scene);
-	auto as_it = canvas_it->second.find("Any");
-	if (fs_it != canvas_it->second.end()) {
-		auto to_it = fs_it->second.find(to_scene);
-		if (to_it == fs_it->second.end()) {
-			to_it = fs_it->second.find("Any");
-		}
-		if (to_it != fs_it->second.end()) {
-			transition = to_it->second.transition;
-			duration = to_it->second.duration;
-		}
+	auto t = resolve_timed(get_decision_table(canvas_name, *canvas_table), from_scene, to_scene);
+	if (t) {
+		transition = t->transition;
+		duration = t->duration;
 	}
-	if (transition.empty() && as_it != canvas_it->second.end()) {
-		auto to_it = as_it->second.find(to_scene);
-		if (to_it == as_it->second.end()) {
-			to_it = as_it->second.find("Any");
-		}
-		if (to_it != as_it->second.end()) {
-			transition = to_it->second.transition;
-			duration = to_it->second.duration;
-		}
+}
+
+static void proc_set_profile(void *data, calldata_t *cd)
+{
+	UNUSED_PARAMETER(data);
+	const char *val = nullptr;
+	std::string canvas_name;
+	if (calldata_get_string(cd, "canvas", &val) && val) {
+		canvas_name = val;
+	} else {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	val = nullptr;
+	std::string profile;
+	if (calldata_get_string(cd, "profile", &val) && val) {
+		profile = val;
+	}
+	bool success = false;
+	run_on_ui_thread([&canvas_name, &profile, &success] { success = switch_profile(canvas_name, profile); });
+	calldata_set_bool(cd, "success", success);
+}
+
+static void proc_set_enabled(void *data, calldata_t *cd)
+{
+	UNUSED_PARAMETER(data);
+	const char *val = nullptr;
+	std::string canvas_name;
+	if (calldata_get_string(cd, "canvas", &val) && val) {
+		canvas_name = val;
+	} else {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	const bool enabled = calldata_bool(cd, "enabled");
+	calldata_set_bool(cd, "success", run_on_ui_thread([&canvas_name, enabled] { set_canvas_enabled(canvas_name, enabled); }));
+}
+
+static void proc_prepare_switch(void *data, calldata_t *cd)
+{
+	UNUSED_PARAMETER(data);
+	const char *val = nullptr;
+	std::string canvas_name;
+	if (calldata_get_string(cd, "canvas", &val) && val) {
+		canvas_name = val;
+	} else {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	val = nullptr;
+	std::string to_scene;
+	if (calldata_get_string(cd, "to_scene", &val) && val) {
+		to_scene = val;
 	}
+	transition_info info{"", 0};
+	bool found = false;
+	run_on_ui_thread([&canvas_name, &to_scene, &info, &found] { found = prepare_switch(canvas_name, to_scene, info); });
+	calldata_set_string(cd, "transition", info.transition.c_str());
+	calldata_set_int(cd, "duration", info.duration);
+	calldata_set_bool(cd, "found", found);
 }
 
 static void proc_get_transition(void *data, calldata_t *cd)
@@ -458,7 +2354,7 @@ static void proc_get_transition(void *data, calldata_t *cd)
 	}
 	string transition;
 	auto duration = 0;
-	get_transition(canvas_name, from_scene, to_scene, transition, duration);
+	run_on_ui_thread([&] { get_transition(canvas_name, from_scene, to_scene, transition, duration); });
 	calldata_set_string(cd, "transition", transition.c_str());
 	calldata_set_int(cd, "duration", duration);
 }
@@ -482,9 +2378,12 @@ bool obs_module_load(void)
 			canvas_transitions[canvasName].push_back(trName);
 		}
 		obs_frontend_source_list_free(&transitions);
+		materialize_all_transitions();
+		schedule_lint_all();
 		auto ttd = new TransitionTableDialog((QMainWindow *)obs_frontend_get_main_window());
 		ttd->setAttribute(Qt::WA_DeleteOnClose);
 		ttd->show();
+		table_dialog = ttd;
 		obs_frontend_pop_ui_translation();
 	};
 
@@ -492,8 +2391,11 @@ bool obs_module_load(void)
 
 	obs_frontend_add_save_callback(frontend_save_load, nullptr);
 	obs_frontend_add_event_callback(frontend_event, nullptr);
+	lint_context = new QObject;
+	set_ui_thread_host(&obs_ui_thread_host);
 
 	signal_handler_connect(obs_get_signal_handler(), "source_rename", source_rename, nullptr);
+	signal_handler_connect(obs_get_signal_handler(), "canvas_create", canvas_create, nullptr);
 
 	transition_table_hotkey = obs_hotkey_pair_register_frontend(
 		"transition-table.enable", obs_module_text("TransitionTable.Enable"), "transition-table.disable",
@@ -503,14 +2405,30 @@ bool obs_module_load(void)
 		ph,
 		"void get_transition_table_transition(string from_scene, string to_scene, out string transition, out int duration)",
 		proc_get_transition, nullptr);
+	proc_handler_add(ph, "void set_transition_table_profile(string canvas, string profile, out bool success)",
+			 proc_set_profile, nullptr);
+	proc_handler_add(ph, "void set_transition_table_enabled(string canvas, bool enabled, out bool success)",
+			 proc_set_enabled, nullptr);
+	proc_handler_add(
+		ph,
+		"void transition_table_prepare_switch(string canvas, string to_scene, out string transition, out int duration, out bool found)",
+		proc_prepare_switch, nullptr);
 	return true;
 }
 
 static obs_websocket_vendor vendor = nullptr;
 
+static void log_vendor_request(const char *type, obs_data_t *request_data)
+{
+	if (switch_log_recording())
+		switch_log_write(SWITCH_LOG_REQUEST, obs_data_get_string(request_data, "canvas"), type,
+				 obs_data_get_json(request_data));
+}
+
 static void vendor_get_transition(obs_data_t *request_data, obs_data_t *response_data, void *param)
 {
 	UNUSED_PARAMETER(param);
+	log_vendor_request("get_transition", request_data);
 	std::string canvas_name = obs_data_get_string(request_data, "canvas");
 	std::string from_scene = obs_data_get_string(request_data, "from_scene");
 	std::string to_scene = obs_data_get_string(request_data, "to_scene");
@@ -525,6 +2443,7 @@ static void vendor_get_transition(obs_data_t *request_data, obs_data_t *response
 static void vendor_set_transition(obs_data_t *request_data, obs_data_t *response_data, void *param)
 {
 	UNUSED_PARAMETER(param);
+	log_vendor_request("set_transition", request_data);
 	std::string canvas_name = obs_data_get_string(request_data, "canvas");
 	if (canvas_name.empty()) {
 		obs_canvas_t *mc = obs_get_main_canvas();
@@ -545,7 +2464,7 @@ static void vendor_set_transition(obs_data_t *request_data, obs_data_t *response
 	}
 	std::string transition = obs_data_get_string(request_data, "transition");
 	if (transition.empty()) {
-		auto canvas_it = transition_table.find(canvas_name);
+		auto canvas_it = find_canvas_table(canvas_name);
 		if (canvas_it == transition_table.end()) {
 			obs_data_set_string(response_data, "error", "Canvas not found in table");
 			obs_data_set_bool(response_data, "success", false);
@@ -557,19 +2476,310 @@ static void vendor_set_transition(obs_data_t *request_data, obs_data_t *response
 			obs_data_set_bool(response_data, "success", false);
 			return;
 		}
-		auto ts_it = fs_it->second.find(to_scene);
-		if (ts_it == fs_it->second.end()) {
+		if (fs_it->second.find(to_scene) == fs_it->second.end()) {
 			obs_data_set_string(response_data, "error", "'to_scene' not found for this 'from_scene'");
 			obs_data_set_bool(response_data, "success", false);
 			return;
 		}
-		fs_it->second.erase(ts_it);
+		apply_undoable_changes("UndoDeleteRules", {{canvas_name, from_scene, to_scene, true, {}}});
 	} else {
 		int duration = obs_data_get_int(request_data, "duration");
-		auto &t = transition_table[canvas_name][from_scene][to_scene];
-		t.transition = transition;
-		t.duration = duration;
+		apply_undoable_changes("UndoSetRule", {{canvas_name, from_scene, to_scene, false, {transition, duration}}});
+	}
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_get_enabled(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("get_enabled", request_data);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	obs_data_set_bool(response_data, "enabled", canvas_enabled(canvas_name));
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_set_enabled(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("set_enabled", request_data);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	if (!obs_data_has_user_value(request_data, "enabled")) {
+		obs_data_set_string(response_data, "error", "'enabled' not set");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	set_canvas_enabled(canvas_name, obs_data_get_bool(request_data, "enabled"));
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_get_profiles(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("get_profiles", request_data);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	const auto profiles_array = obs_data_array_create();
+	auto it = canvas_profiles.find(canvas_name);
+	if (it != canvas_profiles.end()) {
+		for (const auto &profile : it->second) {
+			obs_data_t *p = obs_data_create();
+			obs_data_set_string(p, "name", profile.first.c_str());
+			obs_data_array_push_back(profiles_array, p);
+			obs_data_release(p);
+		}
+	}
+	obs_data_set_array(response_data, "profiles", profiles_array);
+	obs_data_array_release(profiles_array);
+	obs_data_set_string(response_data, "active", get_canvas_settings(canvas_name).profile.c_str());
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_set_profile(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("set_profile", request_data);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	std::string profile = obs_data_get_string(request_data, "profile");
+	if (!switch_profile(canvas_name, profile)) {
+		obs_data_set_string(response_data, "error", "'profile' not found");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_prepare_switch(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("prepare_switch", request_data);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	std::string to_scene = obs_data_get_string(request_data, "to_scene");
+	if (to_scene.empty()) {
+		obs_data_set_string(response_data, "error", "'to_scene' not set");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	transition_info info{"", 0};
+	obs_data_set_bool(response_data, "found", prepare_switch(canvas_name, to_scene, info));
+	obs_data_set_string(response_data, "transition", info.transition.c_str());
+	obs_data_set_int(response_data, "duration", info.duration);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_lint(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("lint", request_data);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	// the snapshot needs the frontend, so it is linted on the UI thread
+	vector<lint_issue> issues;
+	if (!run_on_ui_thread([&canvas_name, &issues] {
+		    rules_snapshot snapshot;
+		    if (take_rules_snapshot(canvas_name, snapshot))
+			    issues = lint_from_snapshot(snapshot);
+		    auto cross_it = cross_canvas_lint_results.find(canvas_name);
+		    if (cross_it != cross_canvas_lint_results.end())
+			    issues.insert(issues.end(), cross_it->second.begin(), cross_it->second.end());
+	    })) {
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	const auto issues_array = obs_data_array_create();
+	for (const auto &issue : issues) {
+		obs_data_t *i = obs_data_create();
+		obs_data_set_string(i, "kind", lint_kind_name(issue.kind));
+		obs_data_set_string(i, "from_scene", issue.from_scene.c_str());
+		obs_data_set_string(i, "to_scene", issue.to_scene.c_str());
+		obs_data_set_string(i, "detail", issue.detail.c_str());
+		obs_data_set_string(i, "message", lint_issue_text(issue).toUtf8().constData());
+		obs_data_array_push_back(issues_array, i);
+		obs_data_release(i);
+	}
+	obs_data_set_array(response_data, "issues", issues_array);
+	obs_data_array_release(issues_array);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_minimize(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("minimize", request_data);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	// minimized here, only the snapshot and applying it happen on the UI thread
+	rules_snapshot snapshot;
+	bool found = false;
+	run_on_ui_thread([&canvas_name, &snapshot, &found] { found = take_rules_snapshot(canvas_name, snapshot); });
+	if (!found) {
+		obs_data_set_string(response_data, "error", "Canvas not found in table");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	minimize_result result;
+	auto minimized = minimize_from_snapshot(snapshot, result);
+	const bool apply = obs_data_get_bool(request_data, "apply") && (result.removed || result.folded);
+	if (apply) {
+		// edits made while minimizing would be lost, the request has to be sent again
+		bool applied = false;
+		run_on_ui_thread([&snapshot, &minimized, &result, &applied] {
+			if (!snapshot_current(snapshot))
+				return;
+			apply_minimized_rules(snapshot.canvas, minimized);
+			log_minimize_result(snapshot.canvas, result);
+			applied = true;
+		});
+		if (!applied) {
+			obs_data_set_string(response_data, "error", "Rules changed while minimizing");
+			obs_data_set_bool(response_data, "success", false);
+			return;
+		}
+	}
+	obs_data_set_int(response_data, "rules_before", (long long)result.rules_before);
+	obs_data_set_int(response_data, "rules_after", (long long)result.rules_after);
+	obs_data_set_int(response_data, "removed", (long long)result.removed);
+	obs_data_set_int(response_data, "folded", (long long)result.folded);
+	obs_data_set_int(response_data, "memory_before", (long long)result.memory_before);
+	obs_data_set_int(response_data, "memory_after", (long long)result.memory_after);
+	obs_data_set_int(response_data, "save_size_before", (long long)result.save_size_before);
+	obs_data_set_int(response_data, "save_size_after", (long long)result.save_size_after);
+	obs_data_set_bool(response_data, "applied", apply);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_get_stats(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	stats_to_data(response_data);
+	if (obs_data_get_bool(request_data, "reset"))
+		reset_stats();
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_start_trace(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	const char *file = obs_data_get_string(request_data, "file");
+	if (!file || !*file) {
+		obs_data_set_string(response_data, "error", "'file' not set");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	if (!start_trace(file)) {
+		obs_data_set_string(response_data, "error", "Trace already recording");
+		obs_data_set_bool(response_data, "success", false);
+		return;
 	}
+	blog(LOG_INFO, "[Transition Table] recording trace to '%s'", file);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_stop_trace(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(request_data);
+	UNUSED_PARAMETER(param);
+	if (!trace_recording()) {
+		obs_data_set_string(response_data, "error", "No trace recording");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	string file;
+	const long long events = stop_trace(file);
+	if (events < 0) {
+		obs_data_set_string(response_data, "error", "Failed to write trace");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	blog(LOG_INFO, "[Transition Table] wrote %lld trace events to '%s'", events, file.c_str());
+	obs_data_set_string(response_data, "file", file.c_str());
+	obs_data_set_int(response_data, "events", events);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_start_recording(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	string file = obs_data_get_string(request_data, "file");
+	if (file.empty()) {
+		obs_data_set_string(response_data, "error", "'file' not set");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	// the log starts with the rules and current scene of every canvas, taken on the UI thread
+	bool started = false;
+	run_on_ui_thread([&file, &started] {
+		if (!switch_log_start(file))
+			return;
+		started = true;
+		materialize_all_transitions();
+		set<string> canvases;
+		for (const auto &it : transition_table) {
+			if (!is_shared_rules(it.first))
+				canvases.insert(it.first);
+		}
+		for (const auto &it : canvas_settings_map)
+			canvases.insert(it.first);
+		for (const auto &canvasName : canvases) {
+			log_rules_snapshot(canvasName);
+			obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+			if (!c)
+				continue;
+			switch_log_write(SWITCH_LOG_CHANNEL_CHANGE, canvasName, get_current_scene_name(c));
+			obs_canvas_release(c);
+		}
+	});
+	if (!started) {
+		obs_data_set_string(response_data, "error", "Already recording or file could not be opened");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	blog(LOG_INFO, "[Transition Table] recording switches to '%s'", file.c_str());
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_stop_recording(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(request_data);
+	UNUSED_PARAMETER(param);
+	const long long entries = switch_log_stop();
+	if (entries < 0) {
+		obs_data_set_string(response_data, "error", "Not recording");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	obs_data_set_int(response_data, "entries", entries);
 	obs_data_set_bool(response_data, "success", true);
 }
 
@@ -577,8 +2787,12 @@ static void vendor_get_table(obs_data_t *request_data, obs_data_t *response_data
 {
 	UNUSED_PARAMETER(request_data);
 	UNUSED_PARAMETER(param);
+	materialize_all_transitions();
 	const auto transitions_array = obs_data_array_create();
 	for (const auto &it : transition_table) {
+		// shared rules are no canvas, get_rule_usage reports them with the canvases using them
+		if (is_shared_rules(it.first))
+			continue;
 		for (const auto &it2 : it.second) {
 			for (const auto &it3 : it2.second) {
 				obs_data_t *transition = obs_data_create();
@@ -593,8 +2807,361 @@ static void vendor_get_table(obs_data_t *request_data, obs_data_t *response_data
 		}
 	}
 	obs_data_set_bool(response_data, "success", true);
-	obs_data_set_array(response_data, "transitions", transitions_array);
-	obs_data_array_release(transitions_array);
+	obs_data_set_array(response_data, "transitions", transitions_array);
+	obs_data_array_release(transitions_array);
+}
+
+static void vendor_get_rule_usage(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	// only the rules that never fired, the ones to prune
+	const bool unused = obs_data_get_bool(request_data, "unused");
+	auto canvas_it = find_canvas_table(canvas_name);
+	const transition_rules empty_rules;
+	const transition_rules &own = canvas_it == transition_table.end() ? empty_rules : canvas_it->second;
+	auto shared = find_shared_rules(canvas_name);
+	const string &shared_key = get_canvas_settings(canvas_name).shared_rules;
+	obs_data_array_t *rules_array = obs_data_array_create();
+	for (const transition_rules *rules : {&own, shared}) {
+		if (!rules)
+			continue;
+		const bool inherited = rules != &own;
+		for (const auto &from : *rules) {
+			auto own_it = own.find(from.first);
+			for (const auto &to : from.second) {
+				if (inherited && own_it != own.end() && own_it->second.count(to.first))
+					continue;
+				const rule_usage *usage = find_rule_usage(inherited ? shared_key : canvas_name, from.first, to.first);
+				if (unused && usage && usage->hits)
+					continue;
+				obs_data_t *rule = obs_data_create();
+				obs_data_set_string(rule, "from_scene", from.first.c_str());
+				obs_data_set_string(rule, "to_scene", to.first.c_str());
+				obs_data_set_string(rule, "transition", to.second.transition.c_str());
+				obs_data_set_bool(rule, "shared", inherited);
+				obs_data_set_int(rule, "hits", usage ? (long long)usage->hits : 0);
+				obs_data_set_int(rule, "last_used", usage ? usage->last_used : 0);
+				obs_data_array_push_back(rules_array, rule);
+				obs_data_release(rule);
+			}
+		}
+	}
+	obs_data_set_array(response_data, "rules", rules_array);
+	obs_data_array_release(rules_array);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+static void vendor_reset_rule_usage(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	std::string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty())
+		rule_usage_table.clear();
+	else
+		rule_usage_table.erase(canvas_name);
+	if (table_dialog)
+		table_dialog->RefreshTable();
+	obs_data_set_bool(response_data, "success", true);
+}
+
+struct canvas_memory {
+	size_t rules = 0;
+	size_t rule_count = 0;
+	decision_table_memory table;
+	size_t profiles = 0;
+	size_t groups = 0;
+	size_t transitions = 0;
+	size_t lint = 0;
+	size_t usage = 0;
+	size_t matrix = 0;
+	// loaded but not parsed yet, kept as obs_data
+	size_t pending_rules = 0;
+
+	size_t total() const
+	{
+		return rules + table.rules + table.index + table.caches + profiles + groups + transitions + lint + usage +
+		       matrix;
+	}
+};
+
+static void add_table_memory(decision_table_memory &memory, const transition_decision_table *dt)
+{
+	if (!dt)
+		return;
+	const decision_table_memory m = dt->memory();
+	memory.rules += m.rules;
+	memory.index += m.index;
+	memory.caches += m.caches;
+	memory.cached_pairs += m.cached_pairs;
+}
+
+// canvas or shared rules key -> estimated heap memory of everything kept for it
+static map<string, canvas_memory> get_memory_usage()
+{
+	map<string, canvas_memory> result;
+	for (const auto &it : transition_table) {
+		auto &m = result[it.first];
+		m.rules = transition_rules_memory(it.second);
+		for (const auto &from : it.second)
+			m.rule_count += from.second.size();
+	}
+	for (const auto &it : decision_tables)
+		add_table_memory(result[it.first].table, it.second.get());
+	for (const auto &it : canvas_profiles) {
+		auto &m = result[it.first];
+		for (const auto &profile : it.second) {
+			m.profiles += transition_rules_memory(profile.second.rules) + sizeof(profile.second) +
+				      string_memory(profile.first);
+			add_table_memory(m.table, profile.second.table.get());
+		}
+	}
+	for (const auto &it : scene_groups)
+		result[it.first].groups = scene_group_table_memory(it.second);
+	for (const auto &it : canvas_transitions) {
+		auto &m = result[it.first];
+		m.transitions = it.second.capacity() * sizeof(string);
+		for (const auto &name : it.second)
+			m.transitions += string_memory(name);
+	}
+	for (const auto *issues_map : {&lint_results, &cross_canvas_lint_results}) {
+		for (const auto &it : *issues_map) {
+			auto &m = result[it.first];
+			m.lint += it.second.capacity() * sizeof(lint_issue);
+			for (const auto &issue : it.second)
+				m.lint += string_memory(issue.from_scene) + string_memory(issue.to_scene) +
+					  string_memory(issue.detail);
+		}
+	}
+	for (const auto &it : rule_usage_table) {
+		auto &m = result[it.first];
+		for (const auto &usage : it.second)
+			m.usage += 4 * sizeof(void *) + sizeof(usage) + string_memory(usage.first.first) +
+				   string_memory(usage.first.second);
+	}
+	for (const auto &it : resolved_matrices) {
+		auto &m = result[it.first];
+		m.matrix = it.second.scenes.capacity() * sizeof(string) + it.second.cells.capacity() * sizeof(uint32_t) +
+			   it.second.palette.capacity() * sizeof(transition_info);
+		for (const auto &name : it.second.scenes)
+			m.matrix += string_memory(name);
+		for (const auto &info : it.second.palette)
+			m.matrix += string_memory(info.transition);
+	}
+	for (const auto &it : pending_transitions)
+		result[it.first].pending_rules = obs_data_array_count(it.second);
+	return result;
+}
+
+static void log_memory_usage()
+{
+	size_t total = 0;
+	for (const auto &it : get_memory_usage()) {
+		const canvas_memory &m = it.second;
+		total += m.total();
+		blog(LOG_INFO,
+		     "[Transition Table] memory '%s': %zu bytes, %zu rules %zu, table %zu, index %zu, caches %zu (%zu pairs), profiles %zu, groups %zu",
+		     it.first.c_str(), m.total(), m.rule_count, m.rules, m.table.rules, m.table.index, m.table.caches,
+		     m.table.cached_pairs, m.profiles, m.groups);
+	}
+	blog(LOG_INFO, "[Transition Table] memory total: %zu bytes", total);
+}
+
+static void vendor_get_memory(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	size_t total = 0;
+	obs_data_array_t *canvases = obs_data_array_create();
+	for (const auto &it : get_memory_usage()) {
+		const canvas_memory &m = it.second;
+		total += m.total();
+		obs_data_t *item = obs_data_create();
+		obs_data_set_string(item, "canvas", it.first.c_str());
+		obs_data_set_int(item, "total", (long long)m.total());
+		obs_data_set_int(item, "rules", (long long)m.rules);
+		obs_data_set_int(item, "rule_count", (long long)m.rule_count);
+		obs_data_set_int(item, "table_rules", (long long)m.table.rules);
+		obs_data_set_int(item, "table_index", (long long)m.table.index);
+		obs_data_set_int(item, "table_caches", (long long)m.table.caches);
+		obs_data_set_int(item, "cached_pairs", (long long)m.table.cached_pairs);
+		obs_data_set_int(item, "profiles", (long long)m.profiles);
+		obs_data_set_int(item, "groups", (long long)m.groups);
+		obs_data_set_int(item, "transitions", (long long)m.transitions);
+		obs_data_set_int(item, "lint", (long long)m.lint);
+		obs_data_set_int(item, "usage", (long long)m.usage);
+		obs_data_set_int(item, "matrix", (long long)m.matrix);
+		obs_data_set_int(item, "pending_rules", (long long)m.pending_rules);
+		obs_data_array_push_back(canvases, item);
+		obs_data_release(item);
+	}
+	obs_data_set_array(response_data, "canvases", canvases);
+	obs_data_array_release(canvases);
+	obs_data_set_int(response_data, "total", (long long)total);
+	obs_data_set_int(response_data, "dialog_widgets", table_dialog ? table_dialog->TableWidgetCount() : 0);
+	if (obs_data_get_bool(request_data, "log"))
+		log_memory_usage();
+	obs_data_set_bool(response_data, "success", true);
+}
+
+// the matrix is only resolved again when the rules or the scenes changed
+static const resolved_matrix *get_resolved_matrix(const string &canvasName, bool &cached)
+{
+	vector<string> scenes = get_canvas_scene_names(canvasName);
+	auto canvas_table = find_resolve_table(canvasName);
+	cached = false;
+	if (scenes.empty() || !canvas_table)
+		return nullptr;
+	auto &matrix = resolved_matrices[canvasName];
+	if (matrix.version && matrix.rules_version == rules_version && matrix.scenes == scenes) {
+		cached = true;
+		return &matrix;
+	}
+	profile_scope scope("transition_table_resolve_matrix", canvasName.c_str());
+	transition_decision_table &dt = get_decision_table(canvasName, *canvas_table);
+	matrix.rules_version = rules_version;
+	matrix.version = ++resolved_matrix_version;
+	matrix.scenes = std::move(scenes);
+	matrix.palette.clear();
+	matrix.cells.assign(matrix.scenes.size() * matrix.scenes.size(), 0);
+	map<pair<string, int>, uint32_t> palette_ids;
+	size_t cell = 0;
+	// every pair once, so the pairs are kept out of the resolve cache
+	for (const auto &from : matrix.scenes) {
+		for (const auto &to : matrix.scenes) {
+			const transition_info *t = dt.resolve_uncached(from, to);
+			if (t) {
+				auto it = palette_ids.emplace(make_pair(t->transition, t->duration),
+							      (uint32_t)matrix.palette.size() + 1);
+				if (it.second)
+					matrix.palette.push_back(*t);
+				matrix.cells[cell] = it.first->second;
+			}
+			cell++;
+		}
+	}
+	return &matrix;
+}
+
+// "list" is comma separated cells, "rle" is comma separated runs of count*cell or single cells,
+// "base64" is the cells as little endian bytes of cell_bytes each
+static bool encode_matrix_cells(const resolved_matrix &matrix, const string &encoding, obs_data_t *response_data)
+{
+	string cells;
+	if (encoding.empty() || encoding == "list") {
+		cells.reserve(matrix.cells.size() * 2);
+		for (size_t i = 0; i < matrix.cells.size(); i++) {
+			if (i)
+				cells += ',';
+			cells += to_string(matrix.cells[i]);
+		}
+	} else if (encoding == "rle") {
+		size_t i = 0;
+		while (i < matrix.cells.size()) {
+			size_t end = i + 1;
+			while (end < matrix.cells.size() && matrix.cells[end] == matrix.cells[i])
+				end++;
+			if (!cells.empty())
+				cells += ',';
+			if (end - i > 1)
+				cells += to_string(end - i) + '*';
+			cells += to_string(matrix.cells[i]);
+			i = end;
+		}
+	} else if (encoding == "base64") {
+		const int cell_bytes = matrix.palette.size() < 0x100 ? 1 : matrix.palette.size() < 0x10000 ? 2 : 4;
+		string bytes;
+		bytes.reserve(matrix.cells.size() * cell_bytes);
+		for (uint32_t value : matrix.cells) {
+			for (int b = 0; b < cell_bytes; b++)
+				bytes += (char)((value >> (8 * b)) & 0xFF);
+		}
+		cells = QByteArray::fromRawData(bytes.data(), (int)bytes.size()).toBase64().constData();
+		obs_data_set_int(response_data, "cell_bytes", cell_bytes);
+	} else {
+		return false;
+	}
+	obs_data_set_string(response_data, "cells", cells.c_str());
+	return true;
+}
+
+static void vendor_get_matrix(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	UNUSED_PARAMETER(param);
+	log_vendor_request("get_matrix", request_data);
+	string canvas_name = obs_data_get_string(request_data, "canvas");
+	if (canvas_name.empty()) {
+		obs_canvas_t *mc = obs_get_main_canvas();
+		canvas_name = obs_canvas_get_name(mc);
+		obs_canvas_release(mc);
+	}
+	const string encoding = obs_data_get_string(request_data, "encoding");
+	bool cached = false;
+	const resolved_matrix *matrix = get_resolved_matrix(canvas_name, cached);
+	if (!matrix) {
+		obs_data_set_string(response_data, "error", "Canvas not found or without scenes");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	obs_data_set_int(response_data, "version", (long long)matrix->version);
+	obs_data_set_bool(response_data, "cached", cached);
+	// the client has this matrix already
+	if (obs_data_get_int(request_data, "version") == (long long)matrix->version) {
+		obs_data_set_bool(response_data, "unchanged", true);
+		obs_data_set_bool(response_data, "success", true);
+		return;
+	}
+	if (!encode_matrix_cells(*matrix, encoding, response_data)) {
+		obs_data_set_string(response_data, "error", "'encoding' must be list, rle or base64");
+		obs_data_set_bool(response_data, "success", false);
+		return;
+	}
+	obs_data_array_t *scenes = names_to_array(matrix->scenes);
+	obs_data_set_array(response_data, "scenes", scenes);
+	obs_data_array_release(scenes);
+	obs_data_array_t *palette = obs_data_array_create();
+	for (const auto &info : matrix->palette) {
+		obs_data_t *item = obs_data_create();
+		obs_data_set_string(item, "transition", info.transition.c_str());
+		obs_data_set_int(item, "duration", info.duration);
+		obs_data_array_push_back(palette, item);
+		obs_data_release(item);
+	}
+	obs_data_set_array(response_data, "transitions", palette);
+	obs_data_array_release(palette);
+	obs_data_set_string(response_data, "encoding", encoding.empty() ? "list" : encoding.c_str());
+	obs_data_set_bool(response_data, "success", true);
+}
+
+// requests that work on the tables directly
+static const struct {
+	const char *type;
+	obs_websocket_request_callback_function callback;
+} ui_vendor_requests[] = {
+	{"get_enabled", vendor_get_enabled},
+	{"get_matrix", vendor_get_matrix},
+	{"get_memory", vendor_get_memory},
+	{"get_profiles", vendor_get_profiles},
+	{"get_rule_usage", vendor_get_rule_usage},
+	{"get_table", vendor_get_table},
+	{"get_transition", vendor_get_transition},
+	{"prepare_switch", vendor_prepare_switch},
+	{"reset_rule_usage", vendor_reset_rule_usage},
+	{"set_enabled", vendor_set_enabled},
+	{"set_profile", vendor_set_profile},
+	{"set_transition", vendor_set_transition},
+};
+
+// obs-websocket calls from its own threads, param is the callback to run on the UI thread
+static void vendor_ui_request(obs_data_t *request_data, obs_data_t *response_data, void *param)
+{
+	auto callback = *(const obs_websocket_request_callback_function *)param;
+	if (!run_on_ui_thread([callback, request_data, response_data] { callback(request_data, response_data, nullptr); }))
+		obs_data_set_bool(response_data, "success", false);
 }
 
 void obs_module_post_load(void)
@@ -602,9 +3169,15 @@ void obs_module_post_load(void)
 	vendor = obs_websocket_register_vendor("transition-table");
 	if (!vendor)
 		return;
-	obs_websocket_vendor_register_request(vendor, "get_transition", vendor_get_transition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "set_transition", vendor_set_transition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "get_table", vendor_get_table, nullptr);
+	for (const auto &request : ui_vendor_requests)
+		obs_websocket_vendor_register_request(vendor, request.type, vendor_ui_request, (void *)&request.callback);
+	obs_websocket_vendor_register_request(vendor, "get_stats", vendor_get_stats, nullptr);
+	obs_websocket_vendor_register_request(vendor, "minimize", vendor_minimize, nullptr);
+	obs_websocket_vendor_register_request(vendor, "lint", vendor_lint, nullptr);
+	obs_websocket_vendor_register_request(vendor, "start_recording", vendor_start_recording, nullptr);
+	obs_websocket_vendor_register_request(vendor, "start_trace", vendor_start_trace, nullptr);
+	obs_websocket_vendor_register_request(vendor, "stop_recording", vendor_stop_recording, nullptr);
+	obs_websocket_vendor_register_request(vendor, "stop_trace", vendor_stop_trace, nullptr);
 }
 
 void obs_module_unload(void)
@@ -613,8 +3186,20 @@ void obs_module_unload(void)
 	obs_frontend_remove_save_callback(frontend_save_load, nullptr);
 	obs_frontend_remove_event_callback(frontend_event, nullptr);
 	signal_handler_disconnect(obs_get_signal_handler(), "source_rename", source_rename, nullptr);
-	transition_table.clear();
-	canvas_transitions.clear();
+	signal_handler_disconnect(obs_get_signal_handler(), "canvas_create", canvas_create, nullptr);
+	clear_transitions();
+	switch_log_stop();
+	if (trace_recording()) {
+		string file;
+		stop_trace(file);
+	}
+	delete linked_files_watcher;
+	linked_files_watcher = nullptr;
+	// owned by lint_context
+	stats_log_timer = nullptr;
+	set_ui_thread_host(nullptr);
+	delete lint_context;
+	lint_context = nullptr;
 }
 
 MODULE_EXPORT const char *obs_module_description(void)
@@ -630,6 +3215,50 @@ MODULE_EXPORT const char *obs_module_name(void)
 TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(parent)
 {
 	canvasCombo = new QComboBox();
+	precedenceCombo = new QComboBox();
+	precedenceCombo->addItem(QString::fromUtf8(obs_module_text("PrecedenceFromScene")), RULE_PRECEDENCE_FROM_SCENE);
+	precedenceCombo->addItem(QString::fromUtf8(obs_module_text("PrecedenceToScene")), RULE_PRECEDENCE_TO_SCENE);
+	connect(precedenceCombo, &QComboBox::currentIndexChanged, [this] {
+		string canvasName = canvasCombo->currentText().toUtf8().constData();
+		if (is_shared_rules(canvasName))
+			return;
+		auto precedence = (enum rule_precedence)precedenceCombo->currentData().toInt();
+		auto cs = edit_canvas_settings(canvasName);
+		if (!cs || cs->precedence == precedence)
+			return;
+		cs->precedence = precedence;
+		canvas_rules_context_changed(canvasName);
+		update_canvas_overrides(canvasName);
+	});
+	onDemandCheckBox = new QCheckBox(QString::fromUtf8(obs_module_text("OnDemand")));
+	onDemandCheckBox->setToolTip(QString::fromUtf8(obs_module_text("OnDemandTooltip")));
+	connect(onDemandCheckBox, &QCheckBox::toggled, [this](bool checked) {
+		set_canvas_on_demand(canvasCombo->currentText().toUtf8().constData(), checked);
+	});
+	studioModeCheckBox = new QCheckBox(QString::fromUtf8(obs_module_text("StudioModeTargeted")));
+	studioModeCheckBox->setToolTip(QString::fromUtf8(obs_module_text("StudioModeTargetedTooltip")));
+	studioModeCheckBox->setChecked(studio_mode_targeted);
+	connect(studioModeCheckBox, &QCheckBox::toggled, [](bool checked) { set_studio_mode_targeted(checked); });
+	enabledCheckBox = new QCheckBox(QString::fromUtf8(obs_module_text("CanvasEnabled")));
+	connect(enabledCheckBox, &QCheckBox::toggled, [this](bool checked) {
+		set_canvas_enabled(canvasCombo->currentText().toUtf8().constData(), checked);
+	});
+	sharedCombo = new QComboBox();
+	connect(sharedCombo, &QComboBox::currentIndexChanged, [this] {
+		if (sharedCombo->currentIndex() < 0)
+			return;
+		set_shared_rules(canvasCombo->currentText().toUtf8().constData(),
+				 sharedCombo->currentData().toString().toUtf8().constData());
+		RefreshTable();
+	});
+	profileCombo = new QComboBox();
+	connect(profileCombo, &QComboBox::currentIndexChanged, [this] {
+		if (profileCombo->currentIndex() < 0)
+			return;
+		string canvasName = canvasCombo->currentText().toUtf8().constData();
+		switch_profile(canvasName, profileCombo->currentData().toString().toUtf8().constData());
+		RefreshTable();
+	});
 	int idx = 0;
 	mainLayout = new QGridLayout;
 	mainLayout->setContentsMargins(0, 0, 0, 0);
@@ -647,6 +3276,10 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 	mainLayout->addWidget(label, 0, idx++, Qt::AlignCenter);
 	QCheckBox *checkbox = new QCheckBox;
 	mainLayout->addWidget(checkbox, 0, idx++, Qt::AlignCenter);
+	label = new QLabel(obs_module_text("Used"));
+	label->setStyleSheet("font-weight: bold;");
+	label->setToolTip(QString::fromUtf8(obs_module_text("UsedTooltip")));
+	mainLayout->addWidget(label, 0, idx++, Qt::AlignCenter);
 	mainLayout->setColumnStretch(0, 1);
 	mainLayout->setColumnStretch(1, 1);
 	mainLayout->setColumnStretch(2, 1);
@@ -666,6 +3299,7 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 	completer->setCompletionMode(QCompleter::PopupCompletion);
 	fromCombo->addItem("", QByteArray(""));
 	fromCombo->addItem(obs_module_text("Any"), QByteArray("Any"));
+	fromCombo->setToolTip(QString::fromUtf8(obs_module_text("SceneTooltip")));
 	mainLayout->addWidget(fromCombo, 1, idx++);
 	toCombo = new QComboBox();
 	toCombo->setEditable(true);
@@ -675,10 +3309,27 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 	completer->setCompletionMode(QCompleter::PopupCompletion);
 	toCombo->addItem("", QByteArray(""));
 	toCombo->addItem(obs_module_text("Any"), QByteArray("Any"));
+	toCombo->setToolTip(QString::fromUtf8(obs_module_text("SceneTooltip")));
 	mainLayout->addWidget(toCombo, 1, idx++);
 
 	connect(canvasCombo, &QComboBox::currentTextChanged, [this] {
 		string canvasName = canvasCombo->currentText().toUtf8().constData();
+		linkButton->setText(QString::fromUtf8(
+			obs_module_text(linked_files.find(canvasName) == linked_files.end() ? "LinkFile" : "UnlinkFile")));
+		precedenceCombo->setCurrentIndex(
+			precedenceCombo->findData(get_canvas_settings(canvasName).precedence));
+		// shared rules are no canvas, they follow the settings of the canvases using them
+		const bool shared = is_shared_rules(canvasName);
+		precedenceCombo->setEnabled(!shared);
+		enabledCheckBox->setEnabled(!shared);
+		enabledCheckBox->setChecked(canvas_enabled(canvasName));
+		obs_canvas_t *c = obs_get_canvas_by_name(canvasName.c_str());
+		onDemandCheckBox->setEnabled(c && !is_main_canvas(c));
+		obs_canvas_release(c);
+		auto cs_it = canvas_settings_map.find(canvasName);
+		onDemandCheckBox->setChecked(cs_it != canvas_settings_map.end() && cs_it->second.on_demand);
+		RefreshSharedRules();
+		RefreshProfiles();
 		transitionCombo->clear();
 		auto ct = canvas_transitions.find(canvasName);
 		if (ct != canvas_transitions.end()) {
@@ -693,20 +3344,41 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 		toCombo->addItem("", QByteArray(""));
 		toCombo->addItem(obs_module_text("Any"), QByteArray("Any"));
 
-		auto canvas = obs_get_canvas_by_name(canvasName.c_str());
-		if (!canvas)
-			return;
-		obs_canvas_enum_scenes(
-			canvas,
-			[](void *param, obs_source_t *scene) {
-				auto ttd = (TransitionTableDialog *)param;
-				string sceneName = obs_source_get_name(scene);
-				ttd->fromCombo->addItem(QString::fromUtf8(sceneName.c_str()), QByteArray(sceneName.c_str()));
-				ttd->toCombo->addItem(QString::fromUtf8(sceneName.c_str()), QByteArray(sceneName.c_str()));
-				return true;
-			},
-			this);
-		obs_canvas_release(canvas);
+		// shared rules offer the scenes of every canvas using them
+		vector<string> sceneCanvases;
+		if (is_shared_rules(canvasName)) {
+			for (const auto &it : canvas_settings_map) {
+				if (it.second.shared_rules == canvasName)
+					sceneCanvases.push_back(it.first);
+			}
+		} else {
+			sceneCanvases.push_back(canvasName);
+		}
+		for (const auto &sceneCanvas : sceneCanvases) {
+			auto canvas = obs_get_canvas_by_name(sceneCanvas.c_str());
+			if (!canvas)
+				continue;
+			obs_canvas_enum_scenes(
+				canvas,
+				[](void *param, obs_source_t *scene) {
+					auto ttd = (TransitionTableDialog *)param;
+					QByteArray sceneName = obs_source_get_name(scene);
+					if (ttd->fromCombo->findData(sceneName) >= 0)
+						return true;
+					ttd->fromCombo->addItem(QString::fromUtf8(sceneName), sceneName);
+					ttd->toCombo->addItem(QString::fromUtf8(sceneName), sceneName);
+					return true;
+				},
+				this);
+			obs_canvas_release(canvas);
+		}
+		auto sg_it = scene_groups.find(canvasName);
+		if (sg_it != scene_groups.end()) {
+			for (const auto &group : sg_it->second.groups) {
+				fromCombo->addItem(QString::fromUtf8(group.first.c_str()), QByteArray(group.first.c_str()));
+				toCombo->addItem(QString::fromUtf8(group.first.c_str()), QByteArray(group.first.c_str()));
+			}
+		}
 		RefreshTable();
 	});
 
@@ -725,7 +3397,20 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 	mainLayout->addWidget(durationSpin, 1, idx++);
 	QPushButton *addButton = new QPushButton(obs_module_text("Set"));
 	connect(addButton, &QPushButton::clicked, [this]() { AddClicked(); });
-	mainLayout->addWidget(addButton, 1, idx++, Qt::AlignCenter);
+	QPushButton *fillRowButton = new QPushButton(obs_module_text("FillRow"));
+	fillRowButton->setToolTip(QString::fromUtf8(obs_module_text("FillRowTooltip")));
+	connect(fillRowButton, &QPushButton::clicked, [this]() { FillClicked(true); });
+	QPushButton *fillColumnButton = new QPushButton(obs_module_text("FillColumn"));
+	fillColumnButton->setToolTip(QString::fromUtf8(obs_module_text("FillColumnTooltip")));
+	connect(fillColumnButton, &QPushButton::clicked, [this]() { FillClicked(false); });
+	auto setButtonsLayout = new QHBoxLayout;
+	setButtonsLayout->setContentsMargins(0, 0, 0, 0);
+	setButtonsLayout->addWidget(addButton);
+	setButtonsLayout->addWidget(fillRowButton);
+	setButtonsLayout->addWidget(fillColumnButton);
+	auto setWidget = new QWidget;
+	setWidget->setLayout(setButtonsLayout);
+	mainLayout->addWidget(setWidget, 1, idx, 1, 2, Qt::AlignCenter);
 
 	RefreshTable();
 
@@ -747,8 +3432,13 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 	QPushButton *closeButton = new QPushButton(QString::fromUtf8(obs_module_text("Close")));
 	QPushButton *exportButton = new QPushButton(QString::fromUtf8(obs_module_text("Export")));
 	QPushButton *matrixButton = new QPushButton(QString::fromUtf8(obs_module_text("Matrix")));
+	QPushButton *groupsButton = new QPushButton(QString::fromUtf8(obs_module_text("Groups")));
 	QPushButton *importButton = new QPushButton(QString::fromUtf8(obs_module_text("Import")));
 	QPushButton *deleteButton = new QPushButton(QString::fromUtf8(obs_module_text("Delete")));
+	QPushButton *setSelectedButton = new QPushButton(QString::fromUtf8(obs_module_text("SetSelected")));
+	setSelectedButton->setToolTip(QString::fromUtf8(obs_module_text("SetSelectedTooltip")));
+	QPushButton *minimizeButton = new QPushButton(QString::fromUtf8(obs_module_text("Minimize")));
+	linkButton = new QPushButton(QString::fromUtf8(obs_module_text("LinkFile")));
 
 	QHBoxLayout *bottomLayout = new QHBoxLayout;
 	bottomLayout->addWidget(
@@ -758,111 +3448,96 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 		0, Qt::AlignLeft);
 	bottomLayout->addWidget(exportButton, 0, Qt::AlignRight);
 	bottomLayout->addWidget(importButton, 0, Qt::AlignRight);
+	bottomLayout->addWidget(linkButton, 0, Qt::AlignRight);
 	bottomLayout->addWidget(matrixButton, 0, Qt::AlignRight);
+	bottomLayout->addWidget(groupsButton, 0, Qt::AlignRight);
+	bottomLayout->addWidget(minimizeButton, 0, Qt::AlignRight);
+	bottomLayout->addWidget(setSelectedButton, 0, Qt::AlignRight);
 	bottomLayout->addWidget(deleteButton, 0, Qt::AlignRight);
 	bottomLayout->addWidget(closeButton, 0, Qt::AlignRight);
 	bottomLayout->setStretch(0, 1);
+	connect(setSelectedButton, &QPushButton::clicked, [this]() { SetSelectedClicked(); });
 	connect(deleteButton, &QPushButton::clicked, [this]() { DeleteClicked(); });
 	connect(closeButton, &QPushButton::clicked, [this]() { close(); });
-	connect(exportButton, &QPushButton::clicked, [this]() {
-		const QString fileName = QFileDialog::getSaveFileName(
-			nullptr, QString::fromUtf8(obs_module_text("SaveTransitionTable")), QString(), "JSON File (*.json)");
-		if (fileName.isEmpty())
-			return;
-		string canvasName = canvasCombo->currentText().toUtf8().constData();
-		auto canvas_it = transition_table.find(canvasName);
-		if (canvas_it == transition_table.end())
-			return;
-
-		const auto fu = fileName.toUtf8();
-
-		const auto transitions_array = obs_data_array_create();
-		bool selection = false;
-		for (auto row = 2; row < mainLayout->rowCount(); row++) {
-			auto *item = mainLayout->itemAtPosition(row, 4);
-			if (!item)
-				continue;
-			auto *checkBox = dynamic_cast<QCheckBox *>(item->widget());
-			if (!checkBox || !checkBox->isChecked())
-				continue;
-
-			item = mainLayout->itemAtPosition(row, 0);
-			auto *label = dynamic_cast<QLabel *>(item->widget());
-			if (!label)
-				continue;
-			string fromScene = label->text().toUtf8().constData();
-			if (fromScene == obs_module_text("Any"))
-				fromScene = "Any";
-
-			auto fs_it = canvas_it->second.find(fromScene);
-			if (fs_it == canvas_it->second.end())
-				continue;
-			item = mainLayout->itemAtPosition(row, 1);
-			label = dynamic_cast<QLabel *>(item->widget());
-			if (!label)
-				continue;
-			string toScene = label->text().toUtf8().constData();
-			if (toScene == obs_module_text("Any"))
-				toScene = "Any";
-			auto ts_it = fs_it->second.find(toScene);
-			if (ts_it == fs_it->second.end())
-				continue;
-			selection = true;
-			obs_data_t *transition = obs_data_create();
-			obs_data_set_string(transition, "from_scene", fromScene.c_str());
-			obs_data_set_string(transition, "to_scene", toScene.c_str());
-			obs_data_set_string(transition, "transition", ts_it->second.transition.c_str());
-			obs_data_set_int(transition, "duration", ts_it->second.duration);
-			obs_data_array_push_back(transitions_array, transition);
-			obs_data_release(transition);
-		}
-		if (!selection) {
-			for (const auto &it : canvas_it->second) {
-				for (const auto &it2 : it.second) {
-					obs_data_t *transition = obs_data_create();
-					obs_data_set_string(transition, "from_scene", it.first.c_str());
-					obs_data_set_string(transition, "to_scene", it2.first.c_str());
-					obs_data_set_string(transition, "transition", it2.second.transition.c_str());
-					obs_data_set_int(transition, "duration", it2.second.duration);
-					obs_data_array_push_back(transitions_array, transition);
-					obs_data_release(transition);
-				}
-			}
-		}
-		obs_data_t *data = obs_data_create();
-		obs_data_set_array(data, "transitions", transitions_array);
-		obs_data_array_release(transitions_array);
-		obs_data_save_json(data, fu.constData());
-		obs_data_release(data);
-	});
-	connect(importButton, &QPushButton::clicked, [this]() {
-		const QString fileName = QFileDialog::getOpenFileName(
-			nullptr, QString::fromUtf8(obs_module_text("LoadTransitionTable")), QString(), "JSON File (*.json)");
-		if (fileName.isEmpty())
-			return;
-		const auto fu = fileName.toUtf8();
-		obs_data_t *data = obs_data_create_from_json_file(fu.constData());
-		string canvasName = canvasCombo->currentText().toUtf8().constData();
-		load_transitions(data, canvasName.c_str());
-		obs_data_release(data);
-		RefreshTable();
-		if (transition_table_enabled) {
-			obs_enum_canvases(
-				[](void *param, obs_canvas_t *canvas) {
-					UNUSED_PARAMETER(param);
-					set_transition_overrides(canvas);
-					return true;
-				},
-				nullptr);
-		}
-	});
+	connect(exportButton, &QPushButton::clicked, [this]() { ExportClicked(); });
+	connect(importButton, &QPushButton::clicked, [this]() { ImportClicked(); });
+	connect(linkButton, &QPushButton::clicked, [this]() { LinkClicked(); });
+	connect(minimizeButton, &QPushButton::clicked, [this]() { MinimizeClicked(); });
 	connect(matrixButton, &QPushButton::clicked, this, &TransitionTableDialog::ShowMatrix);
+	connect(groupsButton, &QPushButton::clicked, this, &TransitionTableDialog::ShowGroups);
 
 	vlayout = new QVBoxLayout;
 	vlayout->setContentsMargins(11, 11, 11, 11);
 
 	auto fl = new QFormLayout;
 	fl->addRow(QString::fromUtf8(obs_module_text("Canvas")), canvasCombo);
+	fl->addRow(QString::fromUtf8(obs_module_text("Precedence")), precedenceCombo);
+	fl->addRow(QString(), enabledCheckBox);
+	fl->addRow(QString(), onDemandCheckBox);
+	fl->addRow(QString(), studioModeCheckBox);
+	auto persistUsageCheckBox = new QCheckBox(QString::fromUtf8(obs_module_text("PersistRuleUsage")));
+	persistUsageCheckBox->setChecked(persist_rule_usage);
+	connect(persistUsageCheckBox, &QCheckBox::toggled, [](bool checked) { persist_rule_usage = checked; });
+	fl->addRow(QString(), persistUsageCheckBox);
+	auto statsSpin = new QSpinBox;
+	statsSpin->setMinimum(0);
+	statsSpin->setMaximum(86400);
+	statsSpin->setSuffix(" s");
+	statsSpin->setSpecialValueText(QString::fromUtf8(obs_module_text("Off")));
+	statsSpin->setValue(stats_log_interval);
+	connect(statsSpin, &QSpinBox::valueChanged, [](int value) { set_stats_log_interval(value); });
+	fl->addRow(QString::fromUtf8(obs_module_text("StatsLogInterval")), statsSpin);
+	lintLabel = new QLabel;
+	lintLabel->setProperty("themeID", "warning");
+	lintLabel->setVisible(false);
+	fl->addRow(QString(), lintLabel);
+	auto sharedLayout = new QHBoxLayout;
+	sharedLayout->addWidget(sharedCombo, 1);
+	shareButton = new QPushButton(QString::fromUtf8(obs_module_text("ShareRules")));
+	connect(shareButton, &QPushButton::clicked, [this] {
+		bool ok = false;
+		const QString name = QInputDialog::getText(this, QString::fromUtf8(obs_module_text("ShareRules")),
+							   QString::fromUtf8(obs_module_text("SharedRulesName")),
+							   QLineEdit::Normal, QString(), &ok);
+		if (!ok || name.isEmpty())
+			return;
+		const string key = create_shared_rules(canvasCombo->currentText().toUtf8().constData(),
+						       name.toUtf8().constData());
+		if (key.empty())
+			return;
+		canvasCombo->addItem(QString::fromUtf8(key.c_str()));
+		RefreshSharedRules();
+		RefreshTable();
+	});
+	sharedLayout->addWidget(shareButton);
+	fl->addRow(QString::fromUtf8(obs_module_text("SharedRules")), sharedLayout);
+	auto profileLayout = new QHBoxLayout;
+	profileLayout->addWidget(profileCombo, 1);
+	QPushButton *addProfileButton = new QPushButton(QString::fromUtf8(obs_module_text("AddProfile")));
+	connect(addProfileButton, &QPushButton::clicked, [this] {
+		bool ok = false;
+		const QString name = QInputDialog::getText(this, QString::fromUtf8(obs_module_text("AddProfile")),
+							   QString::fromUtf8(obs_module_text("ProfileName")), QLineEdit::Normal,
+							   QString(), &ok);
+		if (!ok || name.isEmpty())
+			return;
+		string canvasName = canvasCombo->currentText().toUtf8().constData();
+		// a new profile starts as a copy of the active one
+		auto &profile = add_profile(canvasName, name.toUtf8().constData());
+		if (profile.name != get_canvas_settings(canvasName).profile)
+			profile.rules = get_canvas_table(canvasName);
+		RefreshProfiles();
+	});
+	QPushButton *removeProfileButton = new QPushButton(QString::fromUtf8(obs_module_text("RemoveProfile")));
+	connect(removeProfileButton, &QPushButton::clicked, [this] {
+		string canvasName = canvasCombo->currentText().toUtf8().constData();
+		remove_profile(canvasName, profileCombo->currentData().toString().toUtf8().constData());
+		RefreshProfiles();
+		RefreshTable();
+	});
+	profileLayout->addWidget(addProfileButton);
+	profileLayout->addWidget(removeProfileButton);
+	fl->addRow(QString::fromUtf8(obs_module_text("Profile")), profileLayout);
 	vlayout->addLayout(fl);
 	vlayout->addWidget(scrollArea);
 	vlayout->addLayout(bottomLayout);
@@ -882,6 +3557,8 @@ TransitionTableDialog::TransitionTableDialog(QMainWindow *parent) : QDialog(pare
 			return true;
 		},
 		canvasCombo);
+	for (const auto &key : get_shared_rules_keys())
+		canvasCombo->addItem(QString::fromUtf8(key.c_str()));
 }
 
 TransitionTableDialog::~TransitionTableDialog()
@@ -904,25 +3581,145 @@ void TransitionTableDialog::AddClicked()
 	if (toScene == QString::fromUtf8(obs_module_text("Any")))
 		toScene = "Any";
 
-	auto &t = transition_table[canvasName.toUtf8().constData()][fromScene.toUtf8().constData()][toScene.toUtf8().constData()];
-	t.transition = transition.toUtf8().constData();
-	t.duration = durationSpin->value();
+	const transition_info info = {transition.toUtf8().constData(), durationSpin->value()};
+	apply_undoable_changes("UndoSetRule", {{canvasName.toUtf8().constData(), fromScene.toUtf8().constData(),
+						toScene.toUtf8().constData(), false, info}});
 	RefreshTable();
-	if (transition_table_enabled) {
-		obs_canvas_t *c = obs_get_canvas_by_name(canvasName.toUtf8().constData());
-		if (c) {
-			set_transition_overrides(c);
-			obs_canvas_release(c);
-		}
+}
+
+// the from/to keys of the rules with their checkbox checked
+vector<pair<string, string>> TransitionTableDialog::CheckedRules()
+{
+	vector<pair<string, string>> rules;
+	auto canvas_it = find_canvas_table(canvasCombo->currentText().toUtf8().constData());
+	if (canvas_it == transition_table.end())
+		return rules;
+	for (auto row = 2; row < mainLayout->rowCount(); row++) {
+		auto *item = mainLayout->itemAtPosition(row, 4);
+		if (!item)
+			continue;
+		auto *checkBox = dynamic_cast<QCheckBox *>(item->widget());
+		if (!checkBox || !checkBox->isChecked())
+			continue;
+
+		item = mainLayout->itemAtPosition(row, 0);
+		auto *label = dynamic_cast<QLabel *>(item->widget());
+		if (!label)
+			continue;
+		string fromScene = label->text().toUtf8().constData();
+		if (fromScene == obs_module_text("Any"))
+			fromScene = "Any";
+		auto fs_it = canvas_it->second.find(fromScene);
+		if (fs_it == canvas_it->second.end())
+			continue;
+		item = mainLayout->itemAtPosition(row, 1);
+		label = dynamic_cast<QLabel *>(item->widget());
+		if (!label)
+			continue;
+		string toScene = label->text().toUtf8().constData();
+		if (toScene == obs_module_text("Any"))
+			toScene = "Any";
+
+		if (fs_it->second.find(toScene) == fs_it->second.end())
+			continue;
+		rules.emplace_back(fromScene, toScene);
 	}
+	return rules;
 }
 
 void TransitionTableDialog::DeleteClicked()
 {
-	auto canvasName = canvasCombo->currentText();
-	auto canvas_it = transition_table.find(canvasName.toUtf8().constData());
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+	vector<transition_change> changes;
+	for (const auto &rule : CheckedRules())
+		changes.push_back({canvasName, rule.first, rule.second, true, {}});
+	apply_undoable_changes("UndoDeleteRules", changes);
+	RefreshTable();
+}
+
+void TransitionTableDialog::SetSelectedClicked()
+{
+	const auto transition = transitionCombo->currentText();
+	if (transition.isEmpty())
+		return;
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+	const transition_info info = {transition.toUtf8().constData(), durationSpin->value()};
+	vector<transition_change> changes;
+	for (const auto &rule : CheckedRules())
+		changes.push_back({canvasName, rule.first, rule.second, false, info});
+	apply_undoable_changes("UndoBulkEdit", changes);
+	RefreshTable();
+}
+
+// sets the transition from the from scene to every scene, or from every scene to the to scene
+void TransitionTableDialog::FillClicked(bool row)
+{
+	const auto transition = transitionCombo->currentText();
+	auto sceneText = (row ? fromCombo : toCombo)->currentText();
+	if (sceneText.isEmpty() || transition.isEmpty())
+		return;
+	if (sceneText == QString::fromUtf8(obs_module_text("Any")))
+		sceneText = "Any";
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+	const string scene = sceneText.toUtf8().constData();
+	const transition_info info = {transition.toUtf8().constData(), durationSpin->value()};
+	vector<transition_change> changes;
+	for (int i = 0; i < toCombo->count(); i++) {
+		const string other = toCombo->itemData(i).toByteArray().constData();
+		if (other.empty() || other == "Any" || other == scene || is_scene_group(other))
+			continue;
+		if (row)
+			changes.push_back({canvasName, scene, other, false, info});
+		else
+			changes.push_back({canvasName, other, scene, false, info});
+	}
+	apply_undoable_changes("UndoBulkEdit", changes);
+	RefreshTable();
+}
+
+// the user can close the dialog while the worker runs, it is only touched through the QPointer on the UI thread
+static QPointer<QProgressDialog> create_progress_dialog(const char *text)
+{
+	auto progress = new QProgressDialog(QString::fromUtf8(obs_module_text(text)), QString(), 0, 0,
+					    (QWidget *)obs_frontend_get_main_window());
+	progress->setWindowTitle(QString::fromUtf8(obs_module_text("TransitionTable")));
+	progress->setAttribute(Qt::WA_DeleteOnClose);
+	progress->setMinimumDuration(500);
+	progress->setValue(0);
+	return progress;
+}
+
+static void report_progress(const QPointer<QProgressDialog> &progress, size_t done, size_t count)
+{
+	QMetaObject::invokeMethod(
+		lint_context,
+		[progress, done, count] {
+			if (!progress)
+				return;
+			progress->setMaximum((int)count);
+			progress->setValue((int)done);
+		},
+		Qt::QueuedConnection);
+}
+
+static void close_progress(const QPointer<QProgressDialog> &progress)
+{
+	if (progress)
+		progress->close();
+}
+
+void TransitionTableDialog::ExportClicked()
+{
+	const QString fileName = QFileDialog::getSaveFileName(nullptr, QString::fromUtf8(obs_module_text("SaveTransitionTable")),
+							      QString(), "JSON File (*.json)");
+	if (fileName.isEmpty())
+		return;
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+	auto canvas_it = find_canvas_table(canvasName);
 	if (canvas_it == transition_table.end())
 		return;
+
+	vector<transition_rule> rules;
 	for (auto row = 2; row < mainLayout->rowCount(); row++) {
 		auto *item = mainLayout->itemAtPosition(row, 4);
 		if (!item)
@@ -938,6 +3735,7 @@ void TransitionTableDialog::DeleteClicked()
 		string fromScene = label->text().toUtf8().constData();
 		if (fromScene == obs_module_text("Any"))
 			fromScene = "Any";
+
 		auto fs_it = canvas_it->second.find(fromScene);
 		if (fs_it == canvas_it->second.end())
 			continue;
@@ -948,20 +3746,176 @@ void TransitionTableDialog::DeleteClicked()
 		string toScene = label->text().toUtf8().constData();
 		if (toScene == obs_module_text("Any"))
 			toScene = "Any";
-
 		auto ts_it = fs_it->second.find(toScene);
 		if (ts_it == fs_it->second.end())
 			continue;
-		fs_it->second.erase(ts_it);
+		rules.push_back({string(), fromScene, toScene, ts_it->second});
 	}
-	RefreshTable();
-	if (transition_table_enabled) {
-		obs_canvas_t *c = obs_get_canvas_by_name(canvasName.toUtf8().constData());
-		if (c) {
-			set_transition_overrides(c);
-			obs_canvas_release(c);
+	if (rules.empty()) {
+		for (const auto &it : canvas_it->second) {
+			for (const auto &it2 : it.second)
+				rules.push_back({string(), it.first, it2.first, it2.second});
+		}
+	}
+
+	auto progress = create_progress_dialog("Exporting");
+	thread([progress, rules = std::move(rules), fu = fileName.toUtf8()] {
+		const auto transitions_array = obs_data_array_create();
+		for (size_t i = 0; i < rules.size(); i++) {
+			obs_data_t *transition = obs_data_create();
+			obs_data_set_string(transition, "from_scene", rules[i].from_scene.c_str());
+			obs_data_set_string(transition, "to_scene", rules[i].to_scene.c_str());
+			obs_data_set_string(transition, "transition", rules[i].info.transition.c_str());
+			obs_data_set_int(transition, "duration", rules[i].info.duration);
+			obs_data_array_push_back(transitions_array, transition);
+			obs_data_release(transition);
+			if (i % 1000 == 0)
+				report_progress(progress, i, rules.size());
+		}
+		obs_data_t *data = obs_data_create();
+		obs_data_set_array(data, "transitions", transitions_array);
+		obs_data_array_release(transitions_array);
+		if (!obs_data_save_json(data, fu.constData()))
+			blog(LOG_WARNING, "[Transition Table] failed to export to %s", fu.constData());
+		obs_data_release(data);
+		QMetaObject::invokeMethod(lint_context, [progress] { close_progress(progress); }, Qt::QueuedConnection);
+	}).detach();
+}
+
+void TransitionTableDialog::ImportClicked()
+{
+	const QString fileName = QFileDialog::getOpenFileName(nullptr, QString::fromUtf8(obs_module_text("LoadTransitionTable")),
+							      QString(), "JSON File (*.json)");
+	if (fileName.isEmpty())
+		return;
+	QStringList modes;
+	modes << QString::fromUtf8(obs_module_text("ImportReplace")) << QString::fromUtf8(obs_module_text("ImportMerge"))
+	      << QString::fromUtf8(obs_module_text("ImportKeepExisting"));
+	bool ok = false;
+	const QString modeText = QInputDialog::getItem(this, QString::fromUtf8(obs_module_text("Import")),
+						       QString::fromUtf8(obs_module_text("ImportMode")), modes, IMPORT_MODE_MERGE,
+						       false, &ok);
+	if (!ok)
+		return;
+	const auto mode = (enum import_mode)modes.indexOf(modeText);
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+
+	auto progress = create_progress_dialog("Importing");
+	QPointer<TransitionTableDialog> dialog = this;
+	thread([progress, dialog, mode, canvasName, fu = fileName.toUtf8()] {
+		auto rules = make_shared<vector<transition_rule>>();
+		obs_data_t *data = obs_data_create_from_json_file(fu.constData());
+		if (data) {
+			read_transition_rules(data, canvasName.c_str(), *rules,
+					      [&progress](size_t done, size_t count) { report_progress(progress, done, count); });
+			obs_data_release(data);
+		} else {
+			blog(LOG_WARNING, "[Transition Table] failed to import %s", fu.constData());
+		}
+		QMetaObject::invokeMethod(
+			lint_context,
+			[progress, dialog, mode, rules] {
+				apply_undoable_changes("UndoImport", diff_transition_rules(*rules, mode));
+				if (dialog)
+					dialog->RefreshTable();
+				close_progress(progress);
+			},
+			Qt::QueuedConnection);
+	}).detach();
+}
+
+void TransitionTableDialog::MinimizeClicked()
+{
+	auto snapshot = make_shared<rules_snapshot>();
+	if (!take_rules_snapshot(canvasCombo->currentText().toUtf8().constData(), *snapshot))
+		return;
+	auto progress = create_progress_dialog("Minimizing");
+	QPointer<TransitionTableDialog> dialog = this;
+	thread([progress, dialog, snapshot] {
+		auto result = make_shared<minimize_result>();
+		auto minimized = make_shared<transition_rules>(minimize_from_snapshot(
+			*snapshot, *result, [&progress](size_t done, size_t count) { report_progress(progress, done, count); }));
+		QMetaObject::invokeMethod(
+			lint_context,
+			[progress, dialog, snapshot, result, minimized] {
+				close_progress(progress);
+				if (!dialog)
+					return;
+				if (!result->removed && !result->folded) {
+					QMessageBox::information(dialog, QString::fromUtf8(obs_module_text("Minimize")),
+								 QString::fromUtf8(obs_module_text("MinimizeNothing")));
+					return;
+				}
+				const QString text = QString::fromUtf8(obs_module_text("MinimizeResult"))
+							     .arg((long long)result->rules_before)
+							     .arg((long long)result->rules_after)
+							     .arg((long long)result->folded)
+							     .arg((long long)(result->memory_before - result->memory_after))
+							     .arg((long long)result->save_size_before - (long long)result->save_size_after);
+				if (QMessageBox::question(dialog, QString::fromUtf8(obs_module_text("Minimize")), text) !=
+				    QMessageBox::Yes)
+					return;
+				// the table may have changed while the worker ran
+				if (!snapshot_current(*snapshot))
+					return;
+				apply_minimized_rules(snapshot->canvas, *minimized);
+				log_minimize_result(snapshot->canvas, *result);
+				dialog->RefreshTable();
+			},
+			Qt::QueuedConnection);
+	}).detach();
+}
+
+void TransitionTableDialog::LinkClicked()
+{
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+	if (linked_files.find(canvasName) != linked_files.end()) {
+		unlink_file(canvasName);
+		linkButton->setText(QString::fromUtf8(obs_module_text("LinkFile")));
+		return;
+	}
+	const QString fileName = QFileDialog::getOpenFileName(nullptr, QString::fromUtf8(obs_module_text("LinkFile")), QString(),
+							      "JSON File (*.json)");
+	if (fileName.isEmpty())
+		return;
+	link_file(canvasName, fileName.toUtf8().constData());
+	linkButton->setText(QString::fromUtf8(obs_module_text("UnlinkFile")));
+}
+
+void TransitionTableDialog::RefreshSharedRules()
+{
+	QSignalBlocker blocker(sharedCombo);
+	sharedCombo->clear();
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+	const bool shared = is_shared_rules(canvasName);
+	sharedCombo->setEnabled(!shared);
+	shareButton->setEnabled(!shared);
+	sharedCombo->addItem(QString::fromUtf8(obs_module_text("NoSharedRules")), QString());
+	for (const auto &key : get_shared_rules_keys())
+		sharedCombo->addItem(QString::fromUtf8(key.c_str()), QString::fromUtf8(key.c_str()));
+	auto cs_it = canvas_settings_map.find(canvasName);
+	sharedCombo->setCurrentIndex(
+		cs_it == canvas_settings_map.end()
+			? 0
+			: sharedCombo->findData(QString::fromUtf8(cs_it->second.shared_rules.c_str())));
+}
+
+void TransitionTableDialog::RefreshProfiles()
+{
+	QSignalBlocker blocker(profileCombo);
+	profileCombo->clear();
+	string canvasName = canvasCombo->currentText().toUtf8().constData();
+	profileCombo->addItem(QString::fromUtf8(obs_module_text("DefaultProfile")), QString());
+	auto it = canvas_profiles.find(canvasName);
+	if (it != canvas_profiles.end()) {
+		for (const auto &profile : it->second) {
+			if (!profile.first.empty())
+				profileCombo->addItem(QString::fromUtf8(profile.first.c_str()),
+						      QString::fromUtf8(profile.first.c_str()));
 		}
 	}
+	profileCombo->setCurrentIndex(
+		profileCombo->findData(QString::fromUtf8(get_canvas_settings(canvasName).profile.c_str())));
 }
 
 void TransitionTableDialog::SelectAllChanged()
@@ -982,6 +3936,7 @@ void TransitionTableDialog::SelectAllChanged()
 
 void TransitionTableDialog::RefreshTable()
 {
+	stats_timer timer(stats.refresh_table);
 	auto canvasName = canvasCombo->currentText();
 	auto fromScene = fromCombo->currentText();
 	auto toScene = toCombo->currentText();
@@ -999,55 +3954,109 @@ void TransitionTableDialog::RefreshTable()
 			}
 		}
 	}
-	auto canvas_it = transition_table.find(canvasName.toUtf8().constData());
-	if (canvas_it == transition_table.end())
+	auto canvas_it = find_canvas_table(canvasName.toUtf8().constData());
+	auto shared = find_shared_rules(canvasName.toUtf8().constData());
+	if (canvas_it == transition_table.end() && !shared)
 		return;
+	const transition_rules empty_rules;
+	const transition_rules &own = canvas_it == transition_table.end() ? empty_rules : canvas_it->second;
+	const string canvas_key = canvasName.toUtf8().constData();
+	const string shared_key = get_canvas_settings(canvas_key).shared_rules;
+
+	// from the last lint run, it runs again after every change and refreshes the table when done
+	const auto issues = get_lint_issues(canvasName.toUtf8().constData());
+	map<pair<string, string>, vector<const lint_issue *>> row_issues;
+	for (const auto &issue : issues)
+		row_issues[{issue.from_scene, issue.to_scene}].push_back(&issue);
+	lintLabel->setText(QString::fromUtf8(obs_module_text("LintProblems")).arg((long long)issues.size()));
+	lintLabel->setVisible(!issues.empty());
+	auto key_label = [](const string &key, const vector<const lint_issue *> *key_issues) {
+		auto *label = new QLabel(QString::fromUtf8(key.c_str()));
+		if (key == "Any")
+			label->setText(QString::fromUtf8(obs_module_text("Any")));
+		if (key == "Any" || is_scene_pattern(key) || is_scene_group(key))
+			label->setProperty("themeID", "good");
+		if (!key_issues)
+			return label;
+		for (const auto *issue : *key_issues) {
+			if (issue->detail != key)
+				continue;
+			if (issue->kind == LINT_UNREACHABLE)
+				label->setProperty("themeID", "warning");
+			else if (issue->kind != LINT_MISSING_TRANSITION)
+				label->setProperty("themeID", "error");
+		}
+		return label;
+	};
 
 	int duration = 0;
 	string transition;
 	auto row = 2;
-	for (const auto &it : canvas_it->second) {
-		if (!fromScene.isEmpty() && !QString::fromUtf8(it.first.c_str()).contains(fromScene, Qt::CaseInsensitive))
+	// the shared rules come after the own rules, without a checkbox as they can only be overridden
+	for (const transition_rules *rules : {&own, shared}) {
+		if (!rules)
 			continue;
-		for (const auto &it2 : it.second) {
-			if (!toScene.isEmpty() && !QString::fromUtf8(it2.first.c_str()).contains(toScene, Qt::CaseInsensitive))
+		const bool inherited = rules != &own;
+		for (const auto &it : *rules) {
+			if (!fromScene.isEmpty() && !QString::fromUtf8(it.first.c_str()).contains(fromScene, Qt::CaseInsensitive))
 				continue;
-			auto col = 0;
-			auto *label = new QLabel(QString::fromUtf8(it.first.c_str()));
-			if (it.first == "Any") {
-				label->setProperty("themeID", "good");
-				label->setText(QString::fromUtf8(obs_module_text("Any")));
-			} else {
-				auto scene = obs_get_source_by_name(it.first.c_str());
-				if (scene) {
-					obs_source_release(scene);
-				} else {
-					label->setProperty("themeID", "error");
+			auto own_it = own.find(it.first);
+			for (const auto &it2 : it.second) {
+				if (!toScene.isEmpty() &&
+				    !QString::fromUtf8(it2.first.c_str()).contains(toScene, Qt::CaseInsensitive))
+					continue;
+				if (inherited && own_it != own.end() && own_it->second.count(it2.first))
+					continue;
+				auto col = 0;
+				auto issues_it = inherited ? row_issues.end() : row_issues.find({it.first, it2.first});
+				const auto *cell_issues = issues_it == row_issues.end() ? nullptr : &issues_it->second;
+				QString tooltip;
+				if (cell_issues) {
+					for (const auto *issue : *cell_issues) {
+						if (!tooltip.isEmpty())
+							tooltip += "\n";
+						tooltip += lint_issue_text(*issue);
+					}
 				}
-			}
-			mainLayout->addWidget(label, row, col++);
-			label = new QLabel(QString::fromUtf8(it2.first.c_str()));
-			if (it2.first == "Any") {
-				label->setProperty("themeID", "good");
-				label->setText(QString::fromUtf8(obs_module_text("Any")));
-			} else {
-				auto scene = obs_get_source_by_name(it2.first.c_str());
-				if (scene) {
-					obs_source_release(scene);
-				} else {
-					label->setProperty("themeID", "error");
+				auto *label = key_label(it.first, cell_issues);
+				label->setToolTip(tooltip);
+				mainLayout->addWidget(label, row, col++);
+				label = key_label(it2.first, cell_issues);
+				label->setToolTip(tooltip);
+				mainLayout->addWidget(label, row, col++);
+				label = new QLabel(QString::fromUtf8(it2.second.transition.c_str()));
+				label->setEnabled(!inherited);
+				label->setToolTip(tooltip);
+				if (cell_issues) {
+					for (const auto *issue : *cell_issues) {
+						if (issue->kind == LINT_MISSING_TRANSITION)
+							label->setProperty("themeID", "error");
+						else if (issue->kind == LINT_SHADOWED || issue->kind == LINT_CROSS_CANVAS_SCENE ||
+							 issue->kind == LINT_CROSS_CANVAS_CONFLICT)
+							label->setProperty("themeID", "warning");
+					}
 				}
+				mainLayout->addWidget(label, row, col++);
+				label = new QLabel(QString::fromUtf8((to_string(it2.second.duration) + "ms").c_str()));
+				label->setEnabled(!inherited);
+				mainLayout->addWidget(label, row, col++, Qt::AlignRight);
+				if (!inherited) {
+					auto *checkBox = new QCheckBox;
+					mainLayout->addWidget(checkBox, row, col, Qt::AlignCenter);
+				}
+				col++;
+				const rule_usage *usage =
+					find_rule_usage(inherited ? shared_key : canvas_key, it.first, it2.first);
+				label = new QLabel(QString::number(usage ? (qulonglong)usage->hits : 0));
+				if (usage && usage->last_used)
+					label->setToolTip(QString::fromUtf8(obs_module_text("LastUsed"))
+								  .arg(QDateTime::fromSecsSinceEpoch(usage->last_used)
+									       .toString("yyyy-MM-dd HH:mm:ss")));
+				mainLayout->addWidget(label, row, col++, Qt::AlignRight);
+				duration = it2.second.duration;
+				transition = it2.second.transition;
+				row++;
 			}
-			mainLayout->addWidget(label, row, col++);
-			label = new QLabel(QString::fromUtf8(it2.second.transition.c_str()));
-			mainLayout->addWidget(label, row, col++);
-			label = new QLabel(QString::fromUtf8((to_string(it2.second.duration) + "ms").c_str()));
-			mainLayout->addWidget(label, row, col++, Qt::AlignRight);
-			auto *checkBox = new QCheckBox;
-			mainLayout->addWidget(checkBox, row, col++, Qt::AlignCenter);
-			duration = it2.second.duration;
-			transition = it2.second.transition;
-			row++;
 		}
 	}
 	if (row == 3) {
@@ -1102,9 +4111,14 @@ void TransitionTableDialog::ShowMatrix()
 
 	std::list<std::string> scenes;
 	auto canvasName = canvasCombo->currentText();
-	auto canvas_it = transition_table.find(canvasName.toUtf8().constData());
-	if (canvas_it != transition_table.end()) {
-		for (const auto &it : canvas_it->second) {
+	auto canvas_it = find_canvas_table(canvasName.toUtf8().constData());
+	// the rules inherited from shared rules are shown where the canvas has no own rule
+	const transition_rules *own = canvas_it == transition_table.end() ? nullptr : &canvas_it->second;
+	const transition_rules *shared = find_shared_rules(canvasName.toUtf8().constData());
+	for (const transition_rules *rules : {own, shared}) {
+		if (!rules)
+			continue;
+		for (const auto &it : *rules) {
 			if (it.first != "Any")
 				scenes.push_back(it.first);
 			for (const auto &it2 : it.second) {
@@ -1128,20 +4142,46 @@ void TransitionTableDialog::ShowMatrix()
 							      QTableWidgetItem::ItemType::Type));
 		i++;
 	}
+	// the cells get warmer the more often their rule fired, inherited rules are counted for the shared rules
+	const string canvas_key = canvasName.toUtf8().constData();
+	const string shared_key = get_canvas_settings(canvas_key).shared_rules;
+	uint64_t max_hits = 0;
+	for (const string *key : {&canvas_key, &shared_key}) {
+		auto usage_it = rule_usage_table.find(*key);
+		if (usage_it == rule_usage_table.end())
+			continue;
+		for (const auto &usage : usage_it->second)
+			max_hits = std::max(max_hits, usage.second.hits);
+	}
+	auto find_rule = [](const transition_rules *rules, const string &from, const string &to) -> const transition_info * {
+		if (!rules)
+			return nullptr;
+		auto f1 = rules->find(from);
+		if (f1 == rules->end())
+			return nullptr;
+		auto f2 = f1->second.find(to);
+		return f2 == f1->second.end() ? nullptr : &f2->second;
+	};
 	int row = 0;
-	if (canvas_it != transition_table.end()) {
+	if (own || shared) {
 		for (const auto &it : scenes) {
-			auto f1 = canvas_it->second.find(it);
 			int column = 0;
 			for (const auto &it2 : scenes) {
-				string t;
-				if (f1 != canvas_it->second.end()) {
-					auto f2 = f1->second.find(it2);
-					if (f2 != f1->second.end()) {
-						t = f2->second.transition;
-					}
+				const transition_info *info = find_rule(own, it, it2);
+				const bool inherited = !info;
+				if (inherited)
+					info = find_rule(shared, it, it2);
+				string t = info ? info->transition : string();
+				auto cell = new QLabel(QString::fromUtf8(t.c_str()));
+				cell->setEnabled(!inherited);
+				const rule_usage *usage =
+					t.empty() ? nullptr : find_rule_usage(inherited ? shared_key : canvas_key, it, it2);
+				if (usage && usage->hits && max_hits) {
+					cell->setStyleSheet(QString("background-color: rgba(255, 96, 0, %1);")
+								    .arg(32 + (int)(191 * usage->hits / max_hits)));
+					cell->setToolTip(QString::number((qulonglong)usage->hits));
 				}
-				w->setCellWidget(row, column, new QLabel(QString::fromUtf8(t.c_str())));
+				w->setCellWidget(row, column, cell);
 				column++;
 			}
 			row++;
@@ -1150,6 +4190,48 @@ void TransitionTableDialog::ShowMatrix()
 	const auto m = new QVBoxLayout;
 	m->addWidget(w);
 
+	// sets the transition of every selected cell in one batch, a header click selects a whole row or column
+	const auto matrixTransitionCombo = new QComboBox;
+	matrixTransitionCombo->setEditable(true);
+	for (int j = 0; j < transitionCombo->count(); j++)
+		matrixTransitionCombo->addItem(transitionCombo->itemText(j));
+	matrixTransitionCombo->setCurrentText(transitionCombo->currentText());
+	const auto matrixDurationSpin = new QSpinBox;
+	matrixDurationSpin->setMinimum(50);
+	matrixDurationSpin->setMaximum(20000);
+	matrixDurationSpin->setSingleStep(50);
+	matrixDurationSpin->setSuffix("ms");
+	matrixDurationSpin->setValue(durationSpin->value());
+	QPushButton *setSelectedButton = new QPushButton(QString::fromUtf8(obs_module_text("SetSelected")));
+	connect(setSelectedButton, &QPushButton::clicked,
+		[this, w, matrixTransitionCombo, matrixDurationSpin, canvas_key, names = vector<string>(scenes.begin(), scenes.end())] {
+			const auto transition = matrixTransitionCombo->currentText();
+			if (transition.isEmpty())
+				return;
+			const transition_info info = {transition.toUtf8().constData(), matrixDurationSpin->value()};
+			vector<transition_change> changes;
+			const auto selected = w->selectionModel()->selectedIndexes();
+			for (const auto &index : selected) {
+				const string &from_scene = names[index.row()];
+				const string &to_scene = names[index.column()];
+				if (from_scene == to_scene && from_scene != "Any")
+					continue;
+				changes.push_back({canvas_key, from_scene, to_scene, false, info});
+				auto cell = dynamic_cast<QLabel *>(w->cellWidget(index.row(), index.column()));
+				if (cell)
+					cell->setText(transition);
+				else
+					w->setCellWidget(index.row(), index.column(), new QLabel(transition));
+			}
+			apply_undoable_changes("UndoBulkEdit", changes);
+			RefreshTable();
+		});
+	QHBoxLayout *setButtonsLayout = new QHBoxLayout;
+	setButtonsLayout->addWidget(matrixTransitionCombo, 1);
+	setButtonsLayout->addWidget(matrixDurationSpin);
+	setButtonsLayout->addWidget(setSelectedButton);
+	m->addLayout(setButtonsLayout);
+
 	QPushButton *closeButton = new QPushButton(QString::fromUtf8(obs_module_text("Close")));
 	connect(closeButton, &QPushButton::clicked, [md]() { md->close(); });
 	QHBoxLayout *bottomLayout = new QHBoxLayout;
@@ -1163,3 +4245,105 @@ void TransitionTableDialog::ShowMatrix()
 	md->setLayout(m);
 	md->exec();
 }
+
+void TransitionTableDialog::ShowGroups()
+{
+	const auto gd = new QDialog(this);
+	gd->setWindowTitle(QString::fromUtf8(obs_module_text("Groups")));
+	gd->setAttribute(Qt::WA_DeleteOnClose);
+	gd->setSizeGripEnabled(true);
+
+	const string canvasName = canvasCombo->currentText().toUtf8().constData();
+	const auto groupCombo = new QComboBox;
+	groupCombo->setEditable(true);
+	auto sg_it = scene_groups.find(canvasName);
+	if (sg_it != scene_groups.end()) {
+		for (const auto &group : sg_it->second.groups)
+			groupCombo->addItem(QString::fromUtf8(group.first.c_str() + 6));
+	}
+	const auto sceneList = new QListWidget;
+	auto canvas = obs_get_canvas_by_name(canvasName.c_str());
+	if (canvas) {
+		obs_canvas_enum_scenes(
+			canvas,
+			[](void *param, obs_source_t *scene) {
+				auto item = new QListWidgetItem(QString::fromUtf8(obs_source_get_name(scene)));
+				item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+				item->setCheckState(Qt::Unchecked);
+				((QListWidget *)param)->addItem(item);
+				return true;
+			},
+			sceneList);
+		obs_canvas_release(canvas);
+	}
+	auto loadGroup = [groupCombo, sceneList, canvasName] {
+		const auto groupScenes =
+			get_group_scenes(canvasName, string("group:") + groupCombo->currentText().toUtf8().constData());
+		for (int i = 0; i < sceneList->count(); i++) {
+			auto item = sceneList->item(i);
+			const string sceneName = item->text().toUtf8().constData();
+			const bool member = find(groupScenes.begin(), groupScenes.end(), sceneName) != groupScenes.end();
+			item->setCheckState(member ? Qt::Checked : Qt::Unchecked);
+		}
+	};
+	loadGroup();
+	connect(groupCombo, &QComboBox::currentTextChanged, loadGroup);
+
+	QPushButton *setButton = new QPushButton(QString::fromUtf8(obs_module_text("Set")));
+	connect(setButton, &QPushButton::clicked, [this, groupCombo, sceneList, canvasName] {
+		const string groupName = groupCombo->currentText().toUtf8().constData();
+		if (groupName.empty())
+			return;
+		// scenes that are not in this canvas keep their membership
+		const string group = "group:" + groupName;
+		vector<string> scenes = get_group_scenes(canvasName, group);
+		for (int i = 0; i < sceneList->count(); i++) {
+			auto item = sceneList->item(i);
+			const string sceneName = item->text().toUtf8().constData();
+			auto it = find(scenes.begin(), scenes.end(), sceneName);
+			if (it != scenes.end())
+				scenes.erase(it);
+			if (item->checkState() == Qt::Checked)
+				scenes.push_back(sceneName);
+		}
+		const bool added = scene_groups[canvasName].groups.find(group) == scene_groups[canvasName].groups.end();
+		set_group_scenes(canvasName, group, scenes);
+		scene_group_changed(canvasName, group);
+		if (added) {
+			fromCombo->addItem(QString::fromUtf8(group.c_str()), QByteArray(group.c_str()));
+			toCombo->addItem(QString::fromUtf8(group.c_str()), QByteArray(group.c_str()));
+			if (groupCombo->findText(QString::fromUtf8(groupName.c_str())) < 0)
+				groupCombo->addItem(QString::fromUtf8(groupName.c_str()));
+		}
+	});
+	QPushButton *deleteButton = new QPushButton(QString::fromUtf8(obs_module_text("Delete")));
+	connect(deleteButton, &QPushButton::clicked, [this, groupCombo, canvasName] {
+		const string group = string("group:") + groupCombo->currentText().toUtf8().constData();
+		auto it = scene_groups.find(canvasName);
+		if (it == scene_groups.end() || !it->second.groups.erase(group))
+			return;
+		scene_group_changed(canvasName, group);
+		groupCombo->removeItem(groupCombo->currentIndex());
+		for (auto combo : {fromCombo, toCombo}) {
+			const int index = combo->findData(QByteArray(group.c_str()));
+			if (index >= 0)
+				combo->removeItem(index);
+		}
+	});
+	QPushButton *closeButton = new QPushButton(QString::fromUtf8(obs_module_text("Close")));
+	connect(closeButton, &QPushButton::clicked, [gd]() { gd->close(); });
+
+	const auto m = new QVBoxLayout;
+	auto fl = new QFormLayout;
+	fl->addRow(QString::fromUtf8(obs_module_text("Group")), groupCombo);
+	m->addLayout(fl);
+	m->addWidget(sceneList);
+	QHBoxLayout *bottomLayout = new QHBoxLayout;
+	bottomLayout->addWidget(setButton, 0, Qt::AlignLeft);
+	bottomLayout->addWidget(deleteButton, 0, Qt::AlignLeft);
+	bottomLayout->addStretch(1);
+	bottomLayout->addWidget(closeButton, 0, Qt::AlignRight);
+	m->addLayout(bottomLayout);
+	gd->setLayout(m);
+	gd->exec();
+}
@@ -5,32 +5,58 @@
 #include <QComboBox>
 #include <QDialog>
 #include <QGridLayout>
+#include <QLabel>
 #include <QMainWindow>
+#include <QPushButton>
 #include <QSpinBox>
 
 #include <obs-frontend-api.h>
+#include <string>
+#include <utility>
+#include <vector>
 
 class TransitionTableDialog : public QDialog {
 	Q_OBJECT
 	QGridLayout *mainLayout;
 	QComboBox *canvasCombo;
+	QComboBox *precedenceCombo;
+	QComboBox *profileCombo;
+	QCheckBox *enabledCheckBox;
+	QCheckBox *studioModeCheckBox;
+	QCheckBox *onDemandCheckBox;
+	QComboBox *sharedCombo;
+	QPushButton *shareButton;
 	QComboBox *fromCombo;
 	QComboBox *toCombo;
 	QComboBox *transitionCombo;
 	QSpinBox *durationSpin;
+	QPushButton *linkButton;
+	QLabel *lintLabel;
 
 	//struct obs_frontend_source_list scenes = {};
 	//struct obs_frontend_source_list transitions = {};
 	void AddClicked();
+	std::vector<std::pair<std::string, std::string>> CheckedRules();
 	void DeleteClicked();
+	void ExportClicked();
+	void FillClicked(bool row);
+	void ImportClicked();
+	void LinkClicked();
+	void MinimizeClicked();
+	void RefreshProfiles();
+	void RefreshSharedRules();
 	void SelectAllChanged();
+	void SetSelectedClicked();
 
 public:
 	TransitionTableDialog(QMainWindow *parent = nullptr);
 	~TransitionTableDialog();
+	// widgets in the rule grid, for the memory report
+	int TableWidgetCount() const { return mainLayout->count(); }
 public slots:
 	void RefreshTable();
 	void ShowMatrix();
+	void ShowGroups();
 
 protected:
 	virtual void mouseDoubleClickEvent(QMouseEvent *event) override;
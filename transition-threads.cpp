@@ -0,0 +1,50 @@
+#include "transition-threads.hpp"
+#include <atomic>
+#include <string>
+
+using namespace std;
+
+static atomic<const ui_thread_host *> ui_host{nullptr};
+
+void set_ui_thread_host(const ui_thread_host *host)
+{
+	ui_host = host;
+}
+
+bool run_on_ui_thread(const function<void()> &f)
+{
+	const ui_thread_host *host = ui_host;
+	if (!host)
+		return false;
+	if (host->in_ui_thread()) {
+		f();
+		return true;
+	}
+	if (host->in_graphics_thread()) {
+		host->log_error("waiting for the UI thread from the graphics or audio thread, use queue_on_ui_thread");
+		return false;
+	}
+	return host->invoke(f);
+}
+
+bool on_ui_thread(const char *func)
+{
+	const ui_thread_host *host = ui_host;
+	if (host && host->in_ui_thread())
+		return true;
+	if (host)
+		host->log_error((string(func) + " called outside the UI thread").c_str());
+	return false;
+}
+
+void queue_on_ui_thread(function<void()> f)
+{
+	const ui_thread_host *host = ui_host;
+	if (!host)
+		return;
+	if (host->in_ui_thread()) {
+		f();
+		return;
+	}
+	host->queue(std::move(f));
+}
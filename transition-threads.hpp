@@ -0,0 +1,32 @@
+#pragma once
+
+#include <functional>
+
+// The rules and compiled tables of the plugin are only touched on the UI thread, the websocket, signal, hotkey
+// and task threads hand their work over. The plugin runs this on OBS and Qt, tools/transition-rules-stress on
+// its own event loop, so both go through the same checks.
+struct ui_thread_host {
+	// obs_in_task_thread(OBS_TASK_UI)
+	bool (*in_ui_thread)();
+	// the graphics and audio threads, the UI thread waits for them inside obs_enter_graphics and the audio locks
+	bool (*in_graphics_thread)();
+	// runs f on the UI thread once it gets to it
+	void (*queue)(std::function<void()> f);
+	// runs f on the UI thread and waits for it, false when there is no UI thread left to run it
+	bool (*invoke)(const std::function<void()> &f);
+	void (*log_error)(const char *message);
+};
+
+// set before any other thread can call in, nullptr when the module unloads
+void set_ui_thread_host(const ui_thread_host *host);
+
+// Returns false when f could not run because the module is unloading or the caller is the graphics or audio thread.
+// Waits for the UI thread, so it must not be called while holding a lock the UI thread can take.
+bool run_on_ui_thread(const std::function<void()> &f);
+
+// for the functions that touch the tables, a caller on another thread is missing run_on_ui_thread or
+// queue_on_ui_thread and gets nothing instead of racing the UI thread
+bool on_ui_thread(const char *func);
+
+// for signals, hotkeys and the graphics thread, their handlers hold locks the UI thread can wait for
+void queue_on_ui_thread(std::function<void()> f);